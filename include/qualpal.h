@@ -9,8 +9,10 @@
 #pragma once
 
 #include <qualpal/analyze.h>
+#include <qualpal/color_batch.h>
 #include <qualpal/color_difference.h>
 #include <qualpal/colors.h>
 #include <qualpal/matrix.h>
 #include <qualpal/metrics.h>
+#include <qualpal/palette_cache.h>
 #include <qualpal/qualpal.h>
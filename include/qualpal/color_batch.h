@@ -0,0 +1,350 @@
+/**
+ * @file
+ * @brief Structure-of-arrays containers for sets of colors.
+ *
+ * Provides ColorBatch, which stores the lightness and the two opponent
+ * components of many Lab or DIN99d colors in three separate, 64-byte aligned
+ * arrays. This is the layout that the vectorized color difference kernels
+ * work on: a block of colors can be streamed one component at a time instead
+ * of gathering fields out of an array of color objects.
+ *
+ * The conversions into a batch are vectorized: sRGB linearization uses a
+ * lookup table for 8-bit components (such as colors parsed from hex strings),
+ * and the Lab and DIN99d transfer functions are evaluated a block of colors
+ * at a time.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+#include <qualpal/colors.h>
+#include <type_traits>
+#include <vector>
+
+namespace qualpal {
+namespace detail {
+
+/**
+ * @brief Minimal allocator returning memory aligned to `Alignment` bytes.
+ *
+ * @tparam T Element type.
+ * @tparam Alignment Alignment in bytes (a power of two).
+ */
+template<typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(
+      ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T* p, std::size_t)
+  {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template<typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const
+  {
+    return true;
+  }
+
+  template<typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const
+  {
+    return false;
+  }
+};
+
+// Batched conversion kernels behind ColorBatch and colors::toXYZ(). The
+// outputs are arrays of n values each. xyzToRGB() gives companded sRGB
+// components clamped to [0, 1], like RGB(const XYZ&). labToXYZ() cubes by
+// multiplication rather than with std::pow() so that it vectorizes, and
+// agrees with XYZ(const Lab&) to within a few units in the last place.
+void
+rgbToXYZ(const colors::RGB* rgb,
+         std::size_t n,
+         double* x,
+         double* y,
+         double* z);
+
+void
+xyzToRGB(const double* x,
+         const double* y,
+         const double* z,
+         std::size_t n,
+         double* r,
+         double* g,
+         double* b);
+
+void
+xyzToLab(const double* x,
+         const double* y,
+         const double* z,
+         std::size_t n,
+         const std::array<double, 3>& white_point,
+         double* l,
+         double* a,
+         double* b);
+
+void
+labToXYZ(const double* l,
+         const double* a,
+         const double* b,
+         std::size_t n,
+         const std::array<double, 3>& white_point,
+         double* x,
+         double* y,
+         double* z);
+
+void
+xyzToDIN99d(const double* x,
+            const double* y,
+            const double* z,
+            std::size_t n,
+            const std::array<double, 3>& white_point,
+            double* l,
+            double* a,
+            double* b);
+
+} // namespace detail
+
+namespace colors {
+
+/**
+ * @brief Convert a set of RGB colors to XYZ
+ *
+ * Gives the same results as converting each color with XYZ(const RGB&), but
+ * linearizes 8-bit components through a lookup table instead of evaluating
+ * the sRGB transfer function for every color.
+ *
+ * @param colors RGB colors to convert
+ * @return The colors in XYZ
+ */
+std::vector<XYZ>
+toXYZ(const std::vector<RGB>& colors);
+
+/**
+ * @brief Vector of doubles aligned to a 64-byte (cache line) boundary.
+ */
+using AlignedVector = std::vector<double, detail::AlignedAllocator<double, 64>>;
+
+/**
+ * @brief Structure-of-arrays storage for colors with a lightness and two
+ * opponent components.
+ *
+ * Holds the l, a, and b components of a set of colors in separate, 64-byte
+ * aligned arrays. Used with colors::Lab (LabBatch) and colors::DIN99d
+ * (DIN99dBatch). Colors can be converted in bulk from RGB or XYZ, and
+ * individual colors are read back as ColorType objects.
+ *
+ * @tparam ColorType colors::Lab or colors::DIN99d.
+ *
+ * @code{.cpp}
+ * std::vector<RGB> rgbs = { RGB("#ff0000"), RGB("#00ff00") };
+ * LabBatch labs(rgbs);
+ * double lightness = labs.l()[0];
+ * @endcode
+ *
+ * @see colorDifferenceMatrix(), metrics::CIEDE2000::batch()
+ */
+template<typename ColorType>
+class ColorBatch
+{
+public:
+  /**
+   * @brief Construct an empty batch
+   */
+  ColorBatch() = default;
+
+  /**
+   * @brief Construct a batch from colors in the same color space
+   * @param colors Colors to store
+   */
+  explicit ColorBatch(const std::vector<ColorType>& colors)
+  {
+    reserve(colors.size());
+    for (const auto& color : colors) {
+      push_back(color);
+    }
+  }
+
+  /**
+   * @brief Construct a batch by converting XYZ colors
+   *
+   * The result agrees with converting each color with the ColorType(const
+   * XYZ&, white_point) constructor to within 1e-12.
+   *
+   * @param colors Colors to convert
+   * @param white_point Reference white point (default: D65)
+   */
+  explicit ColorBatch(
+    const std::vector<XYZ>& colors,
+    const std::array<double, 3>& white_point = { 0.95047, 1, 1.08883 })
+  {
+    const std::size_t n = colors.size();
+    AlignedVector x(n), y(n), z(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] = colors[i].x();
+      y[i] = colors[i].y();
+      z[i] = colors[i].z();
+    }
+    convert(x, y, z, white_point);
+  }
+
+  /**
+   * @brief Construct a batch by converting RGB colors
+   * @param colors Colors to convert
+   * @param white_point Reference white point (default: D65)
+   */
+  explicit ColorBatch(
+    const std::vector<RGB>& colors,
+    const std::array<double, 3>& white_point = { 0.95047, 1, 1.08883 })
+  {
+    const std::size_t n = colors.size();
+    AlignedVector x(n), y(n), z(n);
+    detail::rgbToXYZ(colors.data(), n, x.data(), y.data(), z.data());
+    convert(x, y, z, white_point);
+  }
+
+  /** @brief Number of colors in the batch */
+  std::size_t size() const { return l_values.size(); }
+
+  /** @brief Whether the batch is empty */
+  bool empty() const { return l_values.empty(); }
+
+  /**
+   * @brief Reserve storage for `n` colors
+   * @param n Number of colors
+   */
+  void reserve(std::size_t n)
+  {
+    l_values.reserve(n);
+    a_values.reserve(n);
+    b_values.reserve(n);
+  }
+
+  /**
+   * @brief Append a color
+   * @param color Color to append
+   */
+  void push_back(const ColorType& color)
+  {
+    l_values.push_back(color.l());
+    a_values.push_back(color.a());
+    b_values.push_back(color.b());
+  }
+
+  /**
+   * @brief Replace the color at position `i`
+   * @param i Index of the color
+   * @param color New color
+   */
+  void set(std::size_t i, const ColorType& color)
+  {
+    l_values[i] = color.l();
+    a_values[i] = color.a();
+    b_values[i] = color.b();
+  }
+
+  /**
+   * @brief Get the color at position `i`
+   * @param i Index of the color
+   * @return The color as a ColorType object
+   */
+  ColorType operator[](std::size_t i) const
+  {
+    return ColorType(l_values[i], a_values[i], b_values[i]);
+  }
+
+  /** @brief Lightness components */
+  const double* l() const { return l_values.data(); }
+  /** @brief First opponent (green-red) components */
+  const double* a() const { return a_values.data(); }
+  /** @brief Second opponent (blue-yellow) components */
+  const double* b() const { return b_values.data(); }
+
+  /**
+   * @brief Copy the colors into a vector
+   * @return The colors as ColorType objects
+   */
+  std::vector<ColorType> toVector() const
+  {
+    std::vector<ColorType> result;
+    result.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+      result.push_back((*this)[i]);
+    }
+    return result;
+  }
+
+private:
+  void convert(const AlignedVector& x,
+               const AlignedVector& y,
+               const AlignedVector& z,
+               const std::array<double, 3>& white_point)
+  {
+    static_assert(std::is_same_v<ColorType, Lab> ||
+                    std::is_same_v<ColorType, DIN99d>,
+                  "ColorBatch supports Lab and DIN99d colors");
+
+    const std::size_t n = x.size();
+    l_values.resize(n);
+    a_values.resize(n);
+    b_values.resize(n);
+    if constexpr (std::is_same_v<ColorType, Lab>) {
+      detail::xyzToLab(x.data(),
+                       y.data(),
+                       z.data(),
+                       n,
+                       white_point,
+                       l_values.data(),
+                       a_values.data(),
+                       b_values.data());
+    } else {
+      detail::xyzToDIN99d(x.data(),
+                          y.data(),
+                          z.data(),
+                          n,
+                          white_point,
+                          l_values.data(),
+                          a_values.data(),
+                          b_values.data());
+    }
+  }
+
+  AlignedVector l_values;
+  AlignedVector a_values;
+  AlignedVector b_values;
+};
+
+/**
+ * @brief Structure-of-arrays storage for Lab colors.
+ */
+using LabBatch = ColorBatch<Lab>;
+
+/**
+ * @brief Structure-of-arrays storage for DIN99d colors.
+ */
+using DIN99dBatch = ColorBatch<DIN99d>;
+
+} // namespace colors
+} // namespace qualpal
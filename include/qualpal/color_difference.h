@@ -11,9 +11,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <qualpal/color_batch.h>
 #include <qualpal/matrix.h>
 #include <qualpal/metrics.h>
 #include <qualpal/threads.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #ifdef _OPENMP
@@ -29,12 +35,332 @@ estimateMatrixMemory(std::size_t n)
   return n * n * sizeof(double);
 }
 
+template<typename T>
+inline std::size_t
+estimateSymmetricMatrixMemory(std::size_t n)
+{
+  return n * (n + 1) / 2 * sizeof(T);
+}
+
 inline bool
 checkMatrixSize(std::size_t n, double max_gb = 1.0)
 {
   double estimated_gb = estimateMatrixMemory(n) / (1024.0 * 1024.0 * 1024.0);
   return estimated_gb <= max_gb;
 }
+
+template<typename T>
+inline bool
+checkSymmetricMatrixSize(std::size_t n, double max_gb = 1.0)
+{
+  double estimated_gb =
+    estimateSymmetricMatrixMemory<T>(n) / (1024.0 * 1024.0 * 1024.0);
+  return estimated_gb <= max_gb;
+}
+
+template<typename T>
+inline void
+requireSymmetricMatrixSize(std::size_t n, double max_gb)
+{
+  if (n < 1) {
+    throw std::invalid_argument("At least one color is required to compute "
+                                "a color difference matrix.");
+  }
+
+  if (!checkSymmetricMatrixSize<T>(n, max_gb)) {
+    throw std::runtime_error(
+      "Color difference matrix would require " +
+      std::to_string(estimateSymmetricMatrixMemory<T>(n) /
+                     (1024.0 * 1024.0 * 1024.0)) +
+      " GB, which exceeds the limit of " + std::to_string(max_gb) +
+      " GB. Reduce the number of colors or increase the memory limit.");
+  }
+}
+
+// Distances from one color to a contiguous range of colors. Each pair is
+// evaluated with the lower index first, so a row and the corresponding
+// column of a color difference matrix agree exactly.
+template<typename ColorType, typename Metric>
+class DistanceRows
+{
+public:
+  DistanceRows(std::vector<ColorType> colors, const Metric& metric)
+    : colors(std::move(colors))
+    , metric(metric)
+  {
+  }
+
+  // Fill out[k - begin] with the distance between colors i and k for every k
+  // in [begin, end).
+  void operator()(std::size_t i,
+                  std::size_t begin,
+                  std::size_t end,
+                  double* out) const
+  {
+    for (std::size_t k = begin; k < end; ++k) {
+      out[k - begin] =
+        k < i ? metric(colors[k], colors[i]) : metric(colors[i], colors[k]);
+    }
+  }
+
+private:
+  std::vector<ColorType> colors;
+  Metric metric;
+};
+
+// Metrics with a batch() kernel take the coordinates of the colors in their
+// own color space as separate arrays. The kernels are symmetric, so pair
+// order does not matter.
+template<typename ColorType, typename Metric, typename BatchColor>
+class BatchDistanceRows
+{
+public:
+  BatchDistanceRows(const std::vector<ColorType>& input, const Metric& metric)
+    : metric(metric)
+  {
+    colors.reserve(input.size());
+    for (const auto& color : input) {
+      colors.push_back(BatchColor(color));
+    }
+  }
+
+  BatchDistanceRows(colors::ColorBatch<BatchColor> colors,
+                    const Metric& metric)
+    : colors(std::move(colors))
+    , metric(metric)
+  {
+  }
+
+  void operator()(std::size_t i,
+                  std::size_t begin,
+                  std::size_t end,
+                  double* out) const
+  {
+    metric.batch(colors[i],
+                 colors.l() + begin,
+                 colors.a() + begin,
+                 colors.b() + begin,
+                 end - begin,
+                 out);
+  }
+
+private:
+  colors::ColorBatch<BatchColor> colors;
+  Metric metric;
+};
+
+template<typename ColorType>
+class DistanceRows<ColorType, metrics::DIN99d>
+  : public BatchDistanceRows<ColorType, metrics::DIN99d, colors::DIN99d>
+{
+public:
+  using BatchDistanceRows<ColorType, metrics::DIN99d, colors::DIN99d>::
+    BatchDistanceRows;
+};
+
+template<typename ColorType>
+class DistanceRows<ColorType, metrics::CIE76>
+  : public BatchDistanceRows<ColorType, metrics::CIE76, colors::Lab>
+{
+public:
+  using BatchDistanceRows<ColorType, metrics::CIE76, colors::Lab>::
+    BatchDistanceRows;
+};
+
+template<typename ColorType>
+class DistanceRows<ColorType, metrics::CIEDE2000>
+  : public BatchDistanceRows<ColorType, metrics::CIEDE2000, colors::Lab>
+{
+public:
+  using BatchDistanceRows<ColorType, metrics::CIEDE2000, colors::Lab>::
+    BatchDistanceRows;
+};
+
+template<typename ColorType, typename Metric>
+DistanceRows<ColorType, Metric>
+makeDistanceRows(const colors::ColorBatch<ColorType>& batch,
+                 const Metric& metric)
+{
+  return DistanceRows<ColorType, Metric>(batch.toVector(), metric);
+}
+
+// Batches already in the color space of the metric are handed to its kernel
+// as they are.
+inline DistanceRows<colors::DIN99d, metrics::DIN99d>
+makeDistanceRows(const colors::DIN99dBatch& batch,
+                 const metrics::DIN99d& metric)
+{
+  return DistanceRows<colors::DIN99d, metrics::DIN99d>(batch, metric);
+}
+
+inline DistanceRows<colors::Lab, metrics::CIE76>
+makeDistanceRows(const colors::LabBatch& batch, const metrics::CIE76& metric)
+{
+  return DistanceRows<colors::Lab, metrics::CIE76>(batch, metric);
+}
+
+inline DistanceRows<colors::Lab, metrics::CIEDE2000>
+makeDistanceRows(const colors::LabBatch& batch,
+                 const metrics::CIEDE2000& metric)
+{
+  return DistanceRows<colors::Lab, metrics::CIEDE2000>(batch, metric);
+}
+
+inline void
+requireMatrixSize(std::size_t n, double max_gb)
+{
+  if (n < 1) {
+    throw std::invalid_argument("At least one color is required to compute "
+                                "a color difference matrix.");
+  }
+
+  if (!checkMatrixSize(n, max_gb)) {
+    throw std::runtime_error(
+      "Color difference matrix would require " +
+      std::to_string(estimateMatrixMemory(n) / (1024.0 * 1024.0 * 1024.0)) +
+      " GB, which exceeds the limit of " + std::to_string(max_gb) +
+      " GB. Reduce the number of colors or increase the memory limit.");
+  }
+}
+
+// Side of the square tiles used by fullDistanceMatrix(). A tile of doubles
+// takes 128 KiB, which fits comfortably in L2.
+constexpr std::size_t distance_tile = 128;
+
+// Fills the full matrix one tile of the upper triangle at a time. Each tile
+// is computed row by row into a local buffer and then written out twice,
+// once as is and once mirrored, in both cases along contiguous columns of
+// the column-major result. Tiles are handed out dynamically, so the
+// triangular workload is shared evenly between threads.
+template<typename Rows>
+Matrix<double>
+fullDistanceMatrix(const Rows& rows, std::size_t n_colors)
+{
+  Matrix<double> result(n_colors, n_colors);
+
+  const std::size_t tile = distance_tile;
+  const std::size_t n_blocks = (n_colors + tile - 1) / tile;
+
+  // Upper-triangle tile (bi, bj) with bi <= bj, in row-major order.
+  std::vector<std::pair<std::size_t, std::size_t>> tiles;
+  tiles.reserve(n_blocks * (n_blocks + 1) / 2);
+  for (std::size_t bi = 0; bi < n_blocks; ++bi) {
+    for (std::size_t bj = bi; bj < n_blocks; ++bj) {
+      tiles.emplace_back(bi, bj);
+    }
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+  {
+    // buffer[(i - i0) * tile + (j - j0)] holds the distance between i and j.
+    std::vector<double> buffer(tile * tile);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int t = 0; t < static_cast<int>(tiles.size()); ++t) {
+      const std::size_t i0 = tiles[t].first * tile;
+      const std::size_t j0 = tiles[t].second * tile;
+      const std::size_t i1 = std::min(i0 + tile, n_colors);
+      const std::size_t j1 = std::min(j0 + tile, n_colors);
+      const bool diagonal = i0 == j0;
+
+      for (std::size_t i = i0; i < i1; ++i) {
+        // On the diagonal only j > i is needed.
+        const std::size_t begin = diagonal ? i + 1 : j0;
+        if (begin < j1) {
+          rows(i, begin, j1, &buffer[(i - i0) * tile + (begin - j0)]);
+        }
+      }
+
+      // Mirrored part: column i, rows j0..j1.
+      for (std::size_t i = i0; i < i1; ++i) {
+        const std::size_t begin = diagonal ? i + 1 : j0;
+        for (std::size_t j = begin; j < j1; ++j) {
+          result(j, i) = buffer[(i - i0) * tile + (j - j0)];
+        }
+      }
+
+      // Upper part: column j, rows i0..i1.
+      for (std::size_t j = j0; j < j1; ++j) {
+        const std::size_t end = diagonal ? j : i1;
+        for (std::size_t i = i0; i < end; ++i) {
+          result(i, j) = buffer[(i - i0) * tile + (j - j0)];
+        }
+        if (diagonal) {
+          result(j, j) = 0.0;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+template<typename T, typename Rows>
+SymmetricMatrix<T>
+packedDistanceMatrix(const Rows& rows, std::size_t n_colors)
+{
+  SymmetricMatrix<T> result(n_colors);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+  {
+    std::vector<double> column(n_colors);
+
+    // Column j holds j pairs, so a static split would be unbalanced.
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (int j = 0; j < static_cast<int>(n_colors); ++j) {
+      const std::size_t jj = static_cast<std::size_t>(j);
+      rows(jj, 0, jj, column.data());
+      for (std::size_t i = 0; i < jj; ++i) {
+        result(i, jj) = static_cast<T>(column[i]);
+      }
+    }
+  }
+  return result;
+}
+
+// Element (i, j) is the smallest distance between colors i and j over all
+// views, each given by its own rows.
+template<typename T, typename Rows>
+SymmetricMatrix<T>
+minDistanceMatrix(const std::vector<Rows>& rows, std::size_t n_colors)
+{
+  SymmetricMatrix<T> result(n_colors);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+  {
+    std::vector<double> column(n_colors);
+    std::vector<double> view_column(n_colors);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (int j = 0; j < static_cast<int>(n_colors); ++j) {
+      const std::size_t jj = static_cast<std::size_t>(j);
+      std::fill(column.begin(),
+                column.begin() + jj,
+                std::numeric_limits<double>::max());
+      for (const auto& view_rows : rows) {
+        view_rows(jj, 0, jj, view_column.data());
+        for (std::size_t i = 0; i < jj; ++i) {
+          column[i] = std::min(column[i], view_column[i]);
+        }
+      }
+      for (std::size_t i = 0; i < jj; ++i) {
+        result(i, jj) = static_cast<T>(column[i]);
+      }
+    }
+  }
+  return result;
+}
 } // namespace detail
 
 /**
@@ -65,41 +391,173 @@ colorDifferenceMatrix(const std::vector<ColorType>& colors,
                       const Metric& metric = Metric{},
                       const double max_memory = 1)
 {
-  using namespace detail;
+  detail::requireMatrixSize(colors.size(), max_memory);
 
+  return detail::fullDistanceMatrix(
+    detail::DistanceRows<ColorType, Metric>(colors, metric), colors.size());
+}
+
+/**
+ * @brief Generate a symmetric color difference matrix for a batch of colors.
+ *
+ * Overload of colorDifferenceMatrix() for colors stored in structure-of-arrays
+ * form. When the batch is already in the color space of the metric
+ * (colors::DIN99dBatch with metrics::DIN99d, colors::LabBatch with
+ * metrics::CIE76 or metrics::CIEDE2000), it is passed to the batch kernel of
+ * the metric without any conversion.
+ *
+ * @tparam ColorType colors::Lab or colors::DIN99d.
+ * @tparam Metric Color difference metric functor (defaults to metrics::DIN99d).
+ * @param colors Batch of colors to compare.
+ * @param metric Color difference metric to use (optional; default is DIN99d).
+ * @param max_memory Maximum memory (in GB) allowed for the matrix
+ * (default: 1.0).
+ * @return Matrix<double> Symmetric matrix of pairwise color differences [size:
+ * n x n].
+ * @throws std::invalid_argument if fewer than one color is provided.
+ * @throws std::runtime_error if the estimated matrix size exceeds max_memory.
+ *
+ * @see colors::ColorBatch
+ */
+template<typename ColorType, typename Metric = metrics::DIN99d>
+Matrix<double>
+colorDifferenceMatrix(const colors::ColorBatch<ColorType>& colors,
+                      const Metric& metric = Metric{},
+                      const double max_memory = 1)
+{
+  detail::requireMatrixSize(colors.size(), max_memory);
+
+  return detail::fullDistanceMatrix(detail::makeDistanceRows(colors, metric),
+                                    colors.size());
+}
+
+/**
+ * @brief Generate a packed symmetric color difference matrix for a set of
+ * colors.
+ *
+ * Like colorDifferenceMatrix(), but stores only the upper triangle in a
+ * SymmetricMatrix, by default in single precision. Perceptual color
+ * differences do not need double precision, and the packed float storage
+ * needs about a quarter of the memory of the full double matrix, so the same
+ * memory limit fits roughly twice as many colors.
+ *
+ * @tparam T Element type of the result (default: float).
+ * @tparam ColorType Any color class convertible to the required color space.
+ * @tparam Metric Color difference metric functor (defaults to metrics::DIN99d).
+ * @param colors Vector of colors to compare.
+ * @param metric Color difference metric to use (optional; default is DIN99d).
+ * @param max_memory Maximum memory (in GB) allowed for the matrix
+ * (default: 1.0).
+ * @return SymmetricMatrix<T> Pairwise color differences [size: n x n].
+ * @throws std::invalid_argument if fewer than one color is provided.
+ * @throws std::runtime_error if the estimated matrix size exceeds max_memory.
+ *
+ * @see colorDifferenceMatrix(), SymmetricMatrix
+ */
+template<typename T = float,
+         typename ColorType,
+         typename Metric = metrics::DIN99d>
+SymmetricMatrix<T>
+symmetricColorDifferenceMatrix(const std::vector<ColorType>& colors,
+                               const Metric& metric = Metric{},
+                               const double max_memory = 1)
+{
   const std::size_t n_colors = colors.size();
 
-  if (n_colors < 1) {
-    throw std::invalid_argument("At least one color is required to compute "
+  detail::requireSymmetricMatrixSize<T>(n_colors, max_memory);
+
+  return detail::packedDistanceMatrix<T>(
+    detail::DistanceRows<ColorType, Metric>(colors, metric), n_colors);
+}
+
+/**
+ * @brief Generate a packed symmetric color difference matrix for a batch of
+ * colors.
+ *
+ * Overload of symmetricColorDifferenceMatrix() for colors stored in
+ * structure-of-arrays form.
+ *
+ * @tparam T Element type of the result (default: float).
+ * @tparam ColorType colors::Lab or colors::DIN99d.
+ * @tparam Metric Color difference metric functor (defaults to metrics::DIN99d).
+ * @param colors Batch of colors to compare.
+ * @param metric Color difference metric to use (optional; default is DIN99d).
+ * @param max_memory Maximum memory (in GB) allowed for the matrix
+ * (default: 1.0).
+ * @return SymmetricMatrix<T> Pairwise color differences [size: n x n].
+ * @throws std::invalid_argument if fewer than one color is provided.
+ * @throws std::runtime_error if the estimated matrix size exceeds max_memory.
+ *
+ * @see colors::ColorBatch
+ */
+template<typename T = float,
+         typename ColorType,
+         typename Metric = metrics::DIN99d>
+SymmetricMatrix<T>
+symmetricColorDifferenceMatrix(const colors::ColorBatch<ColorType>& colors,
+                               const Metric& metric = Metric{},
+                               const double max_memory = 1)
+{
+  detail::requireSymmetricMatrixSize<T>(colors.size(), max_memory);
+
+  return detail::packedDistanceMatrix<T>(
+    detail::makeDistanceRows(colors, metric), colors.size());
+}
+
+/**
+ * @brief Generate a packed matrix of minimum color differences over several
+ * views of the same colors.
+ *
+ * Each view holds the same colors as seen under some condition, for instance
+ * normal vision followed by one simulated color vision deficiency per view.
+ * Element (i, j) of the result is the smallest difference between colors i
+ * and j across all views. The views are processed together in a single pass,
+ * so only the output matrix is allocated regardless of the number of views.
+ *
+ * @tparam T Element type of the result (default: float).
+ * @tparam ColorType Any color class convertible to the required color space.
+ * @tparam Metric Color difference metric functor (defaults to metrics::DIN99d).
+ * @param views One vector of colors per view, all of the same length.
+ * @param metric Color difference metric to use (optional; default is DIN99d).
+ * @param max_memory Maximum memory (in GB) allowed for the matrix
+ * (default: 1.0).
+ * @return SymmetricMatrix<T> Minimum pairwise color differences [size: n x n].
+ * @throws std::invalid_argument if no views or colors are provided, or if the
+ * views differ in length.
+ * @throws std::runtime_error if the estimated matrix size exceeds max_memory.
+ *
+ * @see symmetricColorDifferenceMatrix()
+ */
+template<typename T = float,
+         typename ColorType,
+         typename Metric = metrics::DIN99d>
+SymmetricMatrix<T>
+minColorDifferenceMatrix(const std::vector<std::vector<ColorType>>& views,
+                         const Metric& metric = Metric{},
+                         const double max_memory = 1)
+{
+  if (views.empty()) {
+    throw std::invalid_argument("At least one view is required to compute "
                                 "a color difference matrix.");
   }
 
-  if (!checkMatrixSize(n_colors, max_memory)) {
-    throw std::runtime_error(
-      "Color difference matrix would require " +
-      std::to_string(estimateMatrixMemory(n_colors) /
-                     (1024.0 * 1024.0 * 1024.0)) +
-      " GB, which exceeds the limit of " + std::to_string(max_memory) +
-      " GB. Reduce the number of colors or increase the memory limit.");
+  const std::size_t n_colors = views.front().size();
+
+  for (const auto& view : views) {
+    if (view.size() != n_colors) {
+      throw std::invalid_argument("All views must contain the same colors.");
+    }
   }
 
-  Matrix<double> result(n_colors, n_colors);
+  detail::requireSymmetricMatrixSize<T>(n_colors, max_memory);
 
-#ifdef _OPENMP
-#pragma omp parallel for num_threads(Threads::get())
-#endif
-  for (int i = 0; i < static_cast<int>(n_colors); ++i) {
-    result(i, i) = 0.0;
-#ifdef _OPENMP
-#pragma omp simd
-#endif
-    for (std::size_t j = static_cast<std::size_t>(i) + 1; j < n_colors; ++j) {
-      double d = metric(colors[i], colors[j]);
-      result(i, j) = d;
-      result(j, i) = d;
-    }
+  std::vector<detail::DistanceRows<ColorType, Metric>> rows;
+  rows.reserve(views.size());
+  for (const auto& view : views) {
+    rows.emplace_back(view, metric);
   }
-  return result;
+
+  return detail::minDistanceMatrix<T>(rows, n_colors);
 }
 
 /**
@@ -134,4 +592,61 @@ colorDifferenceMatrix(const std::vector<colors::XYZ>& colors,
                                                                    1,
                                                                    1.08883 });
 
+/**
+ * @brief Generate a packed symmetric color difference matrix for XYZ colors
+ * with runtime metric selection.
+ *
+ * Runtime-metric counterpart of symmetricColorDifferenceMatrix(), storing
+ * the upper triangle in single precision.
+ *
+ * @param colors Vector of colors::XYZ colors to compare.
+ * @param metric_type Color difference metric to use (DIN99d, CIEDE2000, or
+ * CIE76).
+ * @param max_memory Maximum memory (in GB) allowed for the matrix
+ * (default: 1.0).
+ * @param white_point Reference white point for XYZ to Lab/DIN99d conversions
+ * (default: D65).
+ * @return SymmetricMatrix<float> Pairwise color differences [size: n x n].
+ * @throws std::invalid_argument if the metric type is unsupported or input is
+ * invalid.
+ * @throws std::runtime_error if the estimated matrix size exceeds max_memory.
+ *
+ * @see metrics::MetricType
+ */
+SymmetricMatrix<float>
+symmetricColorDifferenceMatrix(
+  const std::vector<colors::XYZ>& colors,
+  const metrics::MetricType& metric_type,
+  const double max_memory = 1,
+  const std::array<double, 3>& white_point = { 0.95047, 1, 1.08883 });
+
+/**
+ * @brief Generate a packed matrix of minimum color differences over several
+ * views of XYZ colors with runtime metric selection.
+ *
+ * Runtime-metric counterpart of minColorDifferenceMatrix().
+ *
+ * @param views One vector of colors::XYZ colors per view, all of the same
+ * length.
+ * @param metric_type Color difference metric to use (DIN99d, CIEDE2000, or
+ * CIE76).
+ * @param max_memory Maximum memory (in GB) allowed for the matrix
+ * (default: 1.0).
+ * @param white_point Reference white point for XYZ to Lab/DIN99d conversions
+ * (default: D65).
+ * @return SymmetricMatrix<float> Minimum pairwise color differences [size: n x
+ * n].
+ * @throws std::invalid_argument if the metric type is unsupported or input is
+ * invalid.
+ * @throws std::runtime_error if the estimated matrix size exceeds max_memory.
+ *
+ * @see metrics::MetricType
+ */
+SymmetricMatrix<float>
+minColorDifferenceMatrix(
+  const std::vector<std::vector<colors::XYZ>>& views,
+  const metrics::MetricType& metric_type,
+  const double max_memory = 1,
+  const std::array<double, 3>& white_point = { 0.95047, 1, 1.08883 });
+
 } // namespace qualpal
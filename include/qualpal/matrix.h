@@ -2,16 +2,18 @@
  * @file
  * @brief Matrix classes for qualpal.
  *
- * Provides both dynamic (runtime-sized) and fixed-size (compile-time-sized)
- * matrix implementations for color difference calculations and general linear
- * algebra operations. Supports element access, transposition, arithmetic, and
- * multiplication with vectors/matrices.
+ * Provides dynamic (runtime-sized), packed symmetric, and fixed-size
+ * (compile-time-sized) matrix implementations for color difference
+ * calculations and general linear algebra operations. Supports element
+ * access, transposition, arithmetic, and multiplication with
+ * vectors/matrices.
  */
 
 #pragma once
 
 #include <array>
 #include <cassert>
+#include <utility>
 #include <vector>
 
 namespace qualpal {
@@ -124,6 +126,108 @@ private:
   std::vector<T> data;
 };
 
+/**
+ * @brief Square symmetric matrix with packed triangular storage.
+ * @tparam T Element type (typically float or double).
+ *
+ * Stores only the upper triangle (including the diagonal), packed column by
+ * column, so an n x n matrix holds n(n + 1)/2 elements. Element (i, j) and
+ * (j, i) refer to the same storage. Used for color difference matrices, where
+ * single precision and packed storage together need about a quarter of the
+ * memory of a full Matrix<double>.
+ *
+ * Example:
+ * @code
+ * SymmetricMatrix<float> mat(3); // 3 x 3, six stored elements
+ * mat(0, 2) = 1.5f;              // Also sets mat(2, 0)
+ * float v = mat(2, 0);           // 1.5f
+ * @endcode
+ *
+ * @see Matrix for general dynamic-sized matrices
+ */
+template<typename T>
+class SymmetricMatrix
+{
+public:
+  /**
+   * @brief Construct a zero-initialized n x n symmetric matrix
+   * @param n Number of rows (and columns)
+   */
+  explicit SymmetricMatrix(std::size_t n)
+    : n(n)
+    , data(n * (n + 1) / 2)
+  {
+  }
+
+  /**
+   * @brief Default constructor creates an empty matrix (0x0)
+   */
+  SymmetricMatrix()
+    : n(0)
+    , data()
+  {
+  }
+
+  /**
+   * @brief Access matrix element (mutable).
+   * @param row Row index (0-based).
+   * @param col Column index (0-based).
+   * @return Reference to element at (row, col), shared with (col, row).
+   */
+  T& operator()(std::size_t row, std::size_t col)
+  {
+    return data[index(row, col)];
+  }
+
+  /**
+   * @brief Access matrix element (const).
+   * @param row Row index (0-based).
+   * @param col Column index (0-based).
+   * @return Const reference to element at (row, col), shared with (col, row).
+   */
+  const T& operator()(std::size_t row, std::size_t col) const
+  {
+    return data[index(row, col)];
+  }
+
+  /**
+   * @brief Expand into a full (column-major) dynamic matrix
+   * @return Matrix with both triangles filled in
+   */
+  template<typename U = T>
+  Matrix<U> toMatrix() const
+  {
+    Matrix<U> result(n, n);
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t i = 0; i <= j; ++i) {
+        U v = static_cast<U>((*this)(i, j));
+        result(i, j) = v;
+        result(j, i) = v;
+      }
+    }
+    return result;
+  }
+
+  /** @brief Get number of columns */
+  std::size_t ncol() const { return n; }
+
+  /** @brief Get number of rows */
+  std::size_t nrow() const { return n; }
+
+private:
+  std::size_t index(std::size_t row, std::size_t col) const
+  {
+    assert(row < n && col < n);
+    if (row > col) {
+      std::swap(row, col);
+    }
+    return col * (col + 1) / 2 + row;
+  }
+
+  std::size_t n;
+  std::vector<T> data;
+};
+
 /**
  * @brief Fixed-size matrix class with compile-time dimensions.
  * @tparam T Element type (typically double or float).
@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <qualpal/color_batch.h>
 #include <qualpal/colors.h>
 
 namespace qualpal {
@@ -153,6 +155,38 @@ public:
       return d;
     }
   }
+
+  /**
+   * @brief Calculate DIN99d color differences between one color and a block
+   * of colors
+   *
+   * Counterpart of operator() taking the block as separate arrays of L, a,
+   * and b coordinates. The results are identical to those of operator() and
+   * do not depend on the order of the two colors.
+   *
+   * @param x Color to compare against
+   * @param l Lightness of the block colors
+   * @param a Green-red component of the block colors
+   * @param b Blue-yellow component of the block colors
+   * @param n Number of colors in the block
+   * @param out Output array receiving the n DIN99d Delta E values
+   */
+  void batch(const colors::DIN99d& x,
+             const double* l,
+             const double* a,
+             const double* b,
+             std::size_t n,
+             double* out) const
+  {
+    for (std::size_t k = 0; k < n; ++k) {
+      out[k] = std::hypot(x.l() - l[k], x.a() - a[k], x.b() - b[k]);
+    }
+    if (use_power_transform) {
+      for (std::size_t k = 0; k < n; ++k) {
+        out[k] = std::pow(out[k], power) * scale;
+      }
+    }
+  }
 };
 
 /**
@@ -182,6 +216,33 @@ struct CIE76
     colors::Lab l1(c1), l2(c2);
     return std::hypot(l1.l() - l2.l(), l1.a() - l2.a(), l1.b() - l2.b());
   }
+
+  /**
+   * @brief Calculate CIE76 color differences between one color and a block
+   * of colors
+   *
+   * Counterpart of operator() taking the block as separate arrays of L, a,
+   * and b coordinates. The results are identical to those of operator() and
+   * do not depend on the order of the two colors.
+   *
+   * @param x Color to compare against
+   * @param l Lightness of the block colors
+   * @param a Green-red component of the block colors
+   * @param b Blue-yellow component of the block colors
+   * @param n Number of colors in the block
+   * @param out Output array receiving the n CIE76 Delta E values
+   */
+  void batch(const colors::Lab& x,
+             const double* l,
+             const double* a,
+             const double* b,
+             std::size_t n,
+             double* out) const
+  {
+    for (std::size_t k = 0; k < n; ++k) {
+      out[k] = std::hypot(x.l() - l[k], x.a() - a[k], x.b() - b[k]);
+    }
+  }
 };
 
 /**
@@ -309,6 +370,88 @@ public:
 
     return out;
   }
+
+  /**
+   * @brief Calculate CIEDE2000 color differences between one color and a
+   * block of colors
+   *
+   * Vectorized counterpart of operator(), taking the block as separate
+   * arrays of L, a, and b coordinates. On x86-64 the AVX-512, AVX2, or
+   * baseline version is selected at runtime, and all of them give identical
+   * results. These agree with operator() to within 1e-6, except for exactly
+   * complementary hues where the formula itself is discontinuous, and do not
+   * depend on the order of the two colors.
+   *
+   * @param x Color to compare against
+   * @param l Lightness of the block colors
+   * @param a Green-red component of the block colors
+   * @param b Blue-yellow component of the block colors
+   * @param n Number of colors in the block
+   * @param out Output array receiving the n CIEDE2000 Delta E values
+   */
+  void batch(const colors::Lab& x,
+             const double* l,
+             const double* a,
+             const double* b,
+             std::size_t n,
+             double* out) const;
+
+  /**
+   * @brief Calculate CIEDE2000 color differences between one color and every
+   * color in a batch
+   *
+   * @param x Color to compare against
+   * @param y Batch of colors
+   * @param out Output array receiving the y.size() CIEDE2000 Delta E values
+   */
+  void batch(const colors::Lab& x, const colors::LabBatch& y, double* out) const
+  {
+    batch(x, y.l(), y.a(), y.b(), y.size(), out);
+  }
+
+  /**
+   * @brief Calculate lower bounds on the CIEDE2000 color differences between
+   * one color and a block of colors
+   *
+   * The bounds are never larger than the values given by batch(), but cost
+   * only a fraction of them since they skip the hue angles: they are built
+   * from the lightness difference and the Euclidean distance in the a-b
+   * plane, with every hue-dependent factor of the formula taken at its least
+   * favorable value. They are intended for deciding comparisons such as
+   * "is the difference above some threshold?" without evaluating the
+   * formula when the bound already settles it.
+   *
+   * @param x Color to compare against
+   * @param l Lightness of the block colors
+   * @param a Green-red component of the block colors
+   * @param b Blue-yellow component of the block colors
+   * @param n Number of colors in the block
+   * @param out Output array receiving the n lower bounds
+   */
+  void lowerBound(const colors::Lab& x,
+                  const double* l,
+                  const double* a,
+                  const double* b,
+                  std::size_t n,
+                  double* out) const;
+
+  /**
+   * @brief Calculate lower bounds on the CIEDE2000 color differences between
+   * one color and every color in a batch
+   *
+   * @param x Color to compare against
+   * @param y Batch of colors
+   * @param out Output array receiving the y.size() lower bounds
+   *
+   * @see lowerBound(const colors::Lab&, const double*, const double*, const
+   * double*, std::size_t, double*) const
+   */
+  void lowerBound(const colors::Lab& x,
+                  const colors::LabBatch& y,
+                  double* out) const
+  {
+    lowerBound(x, y.l(), y.a(), y.b(), y.size(), out);
+  }
 };
 } // namespace metrics
 } // namespace qualpal
@@ -0,0 +1,212 @@
+/**
+ * @file
+ * @brief Cache for generated palettes.
+ *
+ * Provides PaletteCache, a bounded least-recently-used cache that maps a
+ * Qualpal configuration (see Qualpal::setCache()) to the palette it
+ * generates. It can optionally be backed by a directory on disk so that
+ * palettes survive across processes.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <qualpal/colors.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace qualpal {
+
+/**
+ * @brief Fixed-width key of a palette configuration.
+ *
+ * A 128-bit digest of the configuration, used to look up palettes, plus an
+ * independent 32-bit fingerprint that is stored with each palette and
+ * compared on lookup, so that two configurations with the same digest are
+ * told apart rather than sharing a palette.
+ *
+ * @see PaletteKeyBuilder
+ */
+struct PaletteKey
+{
+  std::uint64_t high = 0;        ///< Upper half of the digest
+  std::uint64_t low = 0;         ///< Lower half of the digest
+  std::uint32_t fingerprint = 0; ///< Collision check
+
+  /**
+   * @brief Digest as 32 lowercase hexadecimal digits
+   * @return The digest, high half first.
+   */
+  std::string digest() const;
+};
+
+/**
+ * @brief Builds a PaletteKey from a sequence of values.
+ *
+ * Values are hashed as they are added, so the configuration is never
+ * written out in full. Numbers are hashed by their bit patterns, so two
+ * values give the same key exactly when they are identical, and the key
+ * does not depend on the platform.
+ *
+ * @code{.cpp}
+ * qualpal::PaletteKey key =
+ *   qualpal::PaletteKeyBuilder().addString("rgb").addNumber(0.5).key();
+ * @endcode
+ */
+class PaletteKeyBuilder
+{
+public:
+  /**
+   * @brief Add an integer
+   * @param value Value to add.
+   * @return Reference to this object for chaining.
+   */
+  PaletteKeyBuilder& addInteger(std::uint64_t value);
+
+  /**
+   * @brief Add a floating-point number
+   * @param value Value to add.
+   * @return Reference to this object for chaining.
+   */
+  PaletteKeyBuilder& addNumber(double value);
+
+  /**
+   * @brief Add a string, prefixed by its length
+   * @param value Value to add.
+   * @return Reference to this object for chaining.
+   */
+  PaletteKeyBuilder& addString(const std::string& value);
+
+  /**
+   * @brief Key of the values added so far
+   * @return The key.
+   */
+  PaletteKey key() const;
+
+private:
+  std::uint64_t first = 0x243f6a8885a308d3;
+  std::uint64_t second = 0x13198a2e03707344;
+  std::uint64_t third = 0xa4093822299f31d0;
+  std::uint64_t count = 0;
+};
+
+/**
+ * @brief Least-recently-used cache of generated palettes.
+ *
+ * Entries are keyed by a PaletteKey built from everything that determines
+ * a palette: the input colors (after parsing, so that equal colors written
+ * differently share a key) or input region, the color vision deficiency
+ * settings, the background, the metric, the memory limit, the white point,
+ * the refinement settings, the seed, the requested size, and the palette
+ * being extended. Colors are stored exactly, so a cached palette is
+ * identical to a freshly generated one.
+ *
+ * When a directory is given, every inserted palette is also written to a
+ * file in that directory, named after the digest of its key, and palettes
+ * missing from memory are looked up there before being counted as misses.
+ * The size limit applies to the palettes held in memory only. Failures to
+ * read or write the directory are ignored, so the cache never makes palette
+ * generation fail.
+ *
+ * All member functions are thread-safe, and one cache can be shared by
+ * several Qualpal objects. Files are read and written without holding the
+ * lock, so lookups in memory never wait for the disk, and several processes
+ * can share one directory.
+ *
+ * @code{.cpp}
+ * auto cache = std::make_shared<qualpal::PaletteCache>(256);
+ * qualpal::Qualpal qp;
+ * qp.setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.8 })
+ *   .setCache(cache);
+ * auto first = qp.generate(6);  // computed
+ * auto second = qp.generate(6); // returned from the cache
+ * std::size_t hits = cache->hits(); // 1
+ * @endcode
+ */
+class PaletteCache
+{
+public:
+  /**
+   * @brief Construct a cache
+   * @param max_entries Maximum number of palettes held in memory.
+   * @param directory Directory for on-disk storage. Created if it does not
+   * exist. Empty (the default) disables on-disk storage.
+   * @throws std::invalid_argument if max_entries is zero.
+   */
+  explicit PaletteCache(std::size_t max_entries = 128,
+                        std::string directory = "");
+
+  /**
+   * @brief Look up a palette
+   * @param key Configuration key.
+   * @return The cached palette, or an empty optional on a miss. A palette
+   * stored under the same digest but another fingerprint is a miss.
+   */
+  std::optional<std::vector<colors::RGB>> find(const PaletteKey& key);
+
+  /**
+   * @brief Store a palette, evicting the least recently used one if the
+   * cache is full
+   * @param key Configuration key.
+   * @param palette Palette to store.
+   */
+  void insert(const PaletteKey& key, const std::vector<colors::RGB>& palette);
+
+  /**
+   * @brief Remove all palettes held in memory and reset the counters
+   *
+   * Files in the cache directory are kept.
+   */
+  void clear();
+
+  /** @brief Number of palettes held in memory */
+  std::size_t size() const;
+
+  /** @brief Maximum number of palettes held in memory */
+  std::size_t maxEntries() const { return max_entries; }
+
+  /** @brief Number of lookups that found a palette */
+  std::size_t hits() const;
+
+  /** @brief Number of lookups that did not find a palette */
+  std::size_t misses() const;
+
+private:
+  using Entry = std::pair<PaletteKey, std::vector<colors::RGB>>;
+  using Digest = std::pair<std::uint64_t, std::uint64_t>;
+
+  struct DigestHash
+  {
+    std::size_t operator()(const Digest& digest) const
+    {
+      return static_cast<std::size_t>(digest.first ^ digest.second);
+    }
+  };
+
+  void insertInMemory(const PaletteKey& key,
+                      const std::vector<colors::RGB>& palette);
+  std::string filePath(const PaletteKey& key) const;
+  std::optional<std::vector<colors::RGB>> readFile(
+    const PaletteKey& key) const;
+  void writeFile(const PaletteKey& key,
+                 const std::vector<colors::RGB>& palette) const;
+
+  std::size_t max_entries;
+  std::string directory;
+
+  // Most recently used first.
+  std::list<Entry> entries;
+  std::unordered_map<Digest, std::list<Entry>::iterator, DigestHash>
+    index;
+  std::size_t hit_count = 0;
+  std::size_t miss_count = 0;
+  mutable std::mutex mutex;
+};
+
+} // namespace qualpal
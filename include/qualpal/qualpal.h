@@ -49,10 +49,13 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <optional>
 #include <qualpal/colors.h>
 #include <qualpal/metrics.h>
+#include <qualpal/palette_cache.h>
 #include <vector>
 
 /**
@@ -75,6 +78,47 @@ enum class ColorspaceType
   LCHab
 };
 
+/**
+ * @enum RefinementStrategy
+ * @brief Which colors the continuous refinement searches around
+ *
+ * The palette score is the smallest difference between any two colors, so
+ * only the colors of the closest pairs (the bottleneck) can raise it
+ * directly.
+ *
+ * - `Sweep` searches around every movable color on every pass, which also
+ *   spreads out the colors that are not on the bottleneck and leaves room
+ *   for later moves. This gives the best palettes.
+ * - `Bottleneck` keeps the differences between all pairs up to date and only
+ *   searches around the colors of the closest pairs, stopping once none of
+ *   them can move. It is several times faster for large palettes, but stops
+ *   in worse local optima, with scores typically 1–10% lower.
+ */
+enum class RefinementStrategy
+{
+  Sweep,
+  Bottleneck
+};
+
+/**
+ * @enum LocalSearch
+ * @brief How the continuous refinement searches around a color
+ *
+ * - `Cube` scans 7×7×7 grids in CIE L*a*b* with steps of ΔE≈1.3, 0.33 and
+ *   0.08, re-centering and rescanning the whole grid after every
+ *   improvement. This evaluates about 340 positions per scan.
+ * - `Pattern` is a pattern search that polls 14 directions (the coordinate
+ *   axes and the cube diagonals) around the current position. It doubles the
+ *   step after a successful poll and halves it after a failed one, down to
+ *   the finest step of `Cube`. This needs far fewer evaluations for palettes
+ *   of similar quality.
+ */
+enum class LocalSearch
+{
+  Cube,
+  Pattern
+};
+
 /**
  * @struct ColorspaceRegion
  * @brief Defines a rectangular region in a cylindrical color space
@@ -100,6 +144,14 @@ struct ColorspaceRegion
  * colorspace), color vision deficiency simulation parameters, background color,
  * color difference metric, and memory limit. The palette is generated by
  * calling generate().
+ *
+ * The candidate colors and the distances between them are kept after
+ * generate() or extend() returns, so that later calls with other palette
+ * sizes skip building them. They are rebuilt after any setter that affects
+ * them, which is every setter except setRefinementStarts(),
+ * setRefinementStrategy(), setLocalSearch(), setAbandonStarts(), setSeed(),
+ * and setCache(), and
+ * when extend() is called with a different palette.
  */
 class Qualpal
 {
@@ -198,6 +250,12 @@ public:
 
   /**
    * @brief Set the maximum memory limit (in GB) for color difference matrix.
+   *
+   * When the full candidate-by-candidate distance matrix would exceed this
+   * limit, the selection switches to a matrix-free mode that computes
+   * distances on demand and only stores distances to the currently selected
+   * colors, so large candidate pools (see setColorspaceSize()) still work.
+   *
    * @param gb Memory limit in gigabytes.
    * @return Reference to this object for chaining.
    * @throws std::invalid_argument if gb <= 0.
@@ -236,6 +294,7 @@ public:
    * distance to the others. With `n_starts > 1`, the refinement is run from
    * additional random seeds (in-region, in-gamut) and the best palette is
    * kept — this escapes basins where the discrete warm start was suboptimal.
+   * See setAbandonStarts() to cut short random seeds that fall behind.
    *
    * Refinement only takes effect when the input source is a colorspace
    * region (HSL or LCHab); for fixed input sets (RGB/hex/named palettes)
@@ -249,6 +308,74 @@ public:
    */
   Qualpal& setRefinementStarts(int n_starts);
 
+  /**
+   * @brief Choose which colors the continuous refinement searches around.
+   *
+   * Experimental. See RefinementStrategy. Only takes effect when
+   * refinement runs (see setRefinementStarts()).
+   *
+   * @param strategy Refinement strategy. Default is
+   * RefinementStrategy::Sweep.
+   * @return Reference to this object for chaining.
+   */
+  Qualpal& setRefinementStrategy(RefinementStrategy strategy);
+
+  /**
+   * @brief Choose how the continuous refinement searches around a color.
+   *
+   * Experimental. See LocalSearch. Only takes effect when refinement runs
+   * (see setRefinementStarts()).
+   *
+   * @param local_search Local search. Default is LocalSearch::Cube.
+   * @return Reference to this object for chaining.
+   */
+  Qualpal& setLocalSearch(LocalSearch local_search);
+
+  /**
+   * @brief Abandon random refinement starts that fall behind.
+   *
+   * Experimental heuristic, off by default. When enabled, the refinement
+   * of a random start (see setRefinementStarts()) is stopped once the gains
+   * of its passes so far suggest that it will not beat the refined warm
+   * start. This is an estimate, not a bound: a start that stalls and then
+   * recovers can be dropped, and the palette may then be worse than with
+   * the option disabled. How much time it saves depends on the input and
+   * is not guaranteed. The palette does not depend on the number of
+   * threads.
+   *
+   * @param abandon Whether to abandon starts early. Default is false.
+   * @return Reference to this object for chaining.
+   */
+  Qualpal& setAbandonStarts(bool abandon);
+
+  /**
+   * @brief Set the seed for the random starts of the refinement.
+   *
+   * The random starts used with `setRefinementStarts(n_starts)` for
+   * `n_starts > 1` are drawn from independent streams derived from this
+   * seed. The same configuration and seed give bit-identical palettes
+   * regardless of the number of threads (see Threads::set()).
+   *
+   * @param seed Seed for the random starts. Default is 0.
+   * @return Reference to this object for chaining.
+   */
+  Qualpal& setSeed(std::uint64_t seed);
+
+  /**
+   * @brief Cache generated palettes.
+   *
+   * When a cache is set, generate() and extend() first look up the palette
+   * for the current configuration and the requested size in the cache, and
+   * only compute (and store) it on a miss. The same cache can be shared by
+   * several Qualpal objects.
+   *
+   * @param cache Cache to use, or `nullptr` (the default) to disable
+   * caching.
+   * @return Reference to this object for chaining.
+   * @see PaletteCache
+   */
+  Qualpal& setCache(std::shared_ptr<PaletteCache> cache);
+
   /**
    * @brief Generate a qualitative color palette with the configured options.
    * @param n Number of colors to generate.
@@ -269,14 +396,56 @@ public:
   std::vector<colors::RGB> extend(const std::vector<colors::RGB>& palette,
                                   std::size_t n);
 
+  /**
+   * @brief Generate palettes of every size from 1 to `max_n`.
+   *
+   * The palettes are nested: the palette for `n` colors is the one for
+   * `n - 1` colors, unchanged, followed by one new color. The new colors
+   * are taken in farthest-first order, each being the candidate farthest
+   * from the ones before it and from the background. With refinement (see
+   * setRefinementStarts()), only the new color is refined, from the same
+   * number of starts as in generate(), and the earlier colors stay fixed.
+   *
+   * The candidates and their distances are built once for all sizes and no
+   * exchanges are made, so this is much faster than calling generate() for
+   * each size. Since earlier colors cannot be revised, a palette is usually
+   * less distinct than the one generate() gives for the same size. With a
+   * cache (see setCache()), every palette of the sequence is looked up and
+   * stored, under keys distinct from those of generate().
+   *
+   * @param max_n Size of the largest palette.
+   * @return The palettes; element `k` holds `k + 1` colors.
+   * @throws std::runtime_error if no input source is configured.
+   * @throws std::invalid_argument for invalid configuration.
+   */
+  std::vector<std::vector<colors::RGB>> generateSequence(std::size_t max_n);
+
 private:
   std::vector<colors::RGB> selectColors(
     std::size_t n,
     const std::vector<colors::RGB>& fixed_palette = {});
 
-  std::vector<colors::RGB> rgb_colors_in;
+  std::vector<colors::RGB> finishPalette(const std::vector<std::size_t>& ind,
+                                         std::size_t n_fixed) const;
+
+  std::vector<colors::RGB> refineColors(std::vector<colors::RGB> rgb,
+                                        std::vector<colors::XYZ> xyz,
+                                        std::size_t n_fixed) const;
+
+  std::vector<colors::RGB> selectCachedColors(
+    std::size_t n,
+    const std::vector<colors::RGB>& fixed_palette = {});
+
+  PaletteKey cacheKey(std::size_t n,
+                      const std::vector<colors::RGB>& fixed_palette,
+                      bool sequence = false) const;
+
+  struct SelectionState;
+
+  std::shared_ptr<const SelectionState> makeSelectionState(
+    const std::vector<colors::RGB>& fixed_palette);
 
-  std::vector<std::string> hex_colors;
+  std::vector<colors::RGB> rgb_colors_in;
 
   std::string palette;
 
@@ -302,6 +471,18 @@ private:
   ColorspaceType colorspace_input = ColorspaceType::HSL;
   std::array<double, 3> white_point = { 0.95047, 1, 1.08883 }; // D65
   int n_refinement_starts = 5;
+  RefinementStrategy refinement_strategy = RefinementStrategy::Sweep;
+  LocalSearch local_search = LocalSearch::Cube;
+  bool abandon_starts = false;
+  std::uint64_t seed = 0;
+  std::shared_ptr<PaletteCache> cache;
+
+  /**
+   * @brief Candidate colors and their distances from the last call to
+   * generate() or extend(), reused until a setter that affects them is
+   * called.
+   */
+  std::shared_ptr<const SelectionState> selection_state;
 };
 
 } // namespace qualpal
@@ -1,4 +1,4 @@
-# Script to convert JSON color palette data into a C++ map format
+# Script to convert JSON color palette data into C++ palette table entries
 # Assumes that the JSON file is structured with outer keys as palette names
 # and inner keys as color categories, with values being lists of color strings.
 
@@ -19,22 +19,26 @@ allowed_outer_keys = ["ochRe"]
 with open(json_file, "r") as f:
     data = json.load(f)
 
-cpp_map = "std::map<std::string, std::map<std::string, std::vector<std::string>>> color_palettes = {\n"
+# Emits entries for BUILTIN_PALETTES in src/qualpal/palettes_data.h, with
+# the colors of each palette stored back to back. Entries must be kept
+# sorted by package and then by name, which is checked at compile time.
+entries = []
 
 for outer_key, outer_value in data.items():
-    if outer_key not in allowed_outer_keys:
+    if outer_key not in allowed_outer_keys or outer_key is None:
         continue
-    if outer_key is not None:
-        cpp_map += '    { "' + to_camel_case(outer_key) + '", {\n'
+    package = to_camel_case(outer_key)
     for inner_key, inner_value in outer_value.items():
-        if inner_key is not None:
-            cpp_map += '        { "' + to_camel_case(inner_key) + '", {\n'
-        for color in inner_value:
-            if color is not None:
-                cpp_map += '            "' + color + '",\n'
-        cpp_map = cpp_map.rstrip(",\n") + "\n        } },\n"
-    cpp_map = cpp_map.rstrip(",\n") + "\n    } },\n"
-cpp_map = cpp_map.rstrip(",\n") + "\n};"
+        if inner_key is None:
+            continue
+        colors = [color for color in inner_value if color is not None]
+        lines = ["".join(colors[i : i + 9]) for i in range(0, len(colors), 9)]
+        entry = '    { "' + package + '",\n'
+        entry += '      "' + to_camel_case(inner_key) + '",\n'
+        entry += "\n".join('      "' + line + '"' for line in lines) + " },"
+        entries.append(entry)
+
+entries.sort()
 
 with open(output_file, "w") as f:
-    f.write(cpp_map)
+    f.write("\n".join(entries) + "\n")
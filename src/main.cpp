@@ -3,6 +3,7 @@
 #include "qualpal/validation.h"
 #include <CLI/CLI.hpp>
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <qualpal.h>
 #include <stdexcept>
@@ -219,14 +220,7 @@ main(int argc, char** argv)
 
     try {
       if (analyze_input == "hex") {
-        for (const auto& color : analyze_values) {
-          if (!qualpal::isValidHexColor(color)) {
-            std::cerr << "Error: Invalid hex color '" << color
-                      << "'. Expected format: #RRGGBB or #RGB" << std::endl;
-            return 1;
-          }
-          rgb_colors.emplace_back(color);
-        }
+        rgb_colors = qualpal::parseHexColors(analyze_values);
       } else if (analyze_input == "colorspace") {
         std::cerr << "Error: 'colorspace' input is not supported for analyze."
                   << std::endl;
@@ -237,9 +231,11 @@ main(int argc, char** argv)
                     << std::endl;
           return 1;
         }
-        auto hex_colors = qualpal::getPalette(analyze_values[0]);
-        for (const auto& hex : hex_colors) {
-          rgb_colors.emplace_back(hex);
+        const auto& pal = qualpal::findPalette(analyze_values[0]);
+        for (std::size_t i = 0; i < pal.size(); ++i) {
+          const auto rgb = pal.rgb(i);
+          rgb_colors.emplace_back(
+            rgb[0] / 255.0, rgb[1] / 255.0, rgb[2] / 255.0);
         }
       }
     } catch (const std::invalid_argument& e) {
@@ -350,13 +346,15 @@ main(int argc, char** argv)
 
   try {
     if (!background.empty()) {
-      if (!qualpal::isValidHexColor(background)) {
+      std::array<unsigned char, 3> bg;
+      if (const auto error = qualpal::parseHexColor(background, bg)) {
         std::cerr << "Error: Invalid background color '" << background
-                  << "'. Expected format: #RRGGBB or #RGB" << std::endl;
+                  << "': " << error->reason
+                  << ". Expected format: #RRGGBB or #RGB" << std::endl;
         return 1;
       }
-      auto bg = qualpal::colors::RGB(background);
-      qp.setBackground(bg);
+      qp.setBackground(
+        qualpal::colors::RGB(bg[0] / 255.0, bg[1] / 255.0, bg[2] / 255.0));
     }
 
     qp.setCvd(cvd);
@@ -369,13 +367,16 @@ main(int argc, char** argv)
 
     // Validate fixed (extend) colors once (always hex)
     if (do_extend) {
+      std::array<unsigned char, 3> rgb;
       for (const auto& hex : extend_colors) {
-        if (!qualpal::isValidHexColor(hex)) {
+        if (const auto error = qualpal::parseHexColor(hex, rgb)) {
           std::cerr << "Error: Invalid hex color in --extend '" << hex
-                    << "'. Expected format: #RRGGBB or #RGB" << std::endl;
+                    << "': " << error->reason
+                    << ". Expected format: #RRGGBB or #RGB" << std::endl;
           return 1;
         }
-        fixed_palette.emplace_back(hex);
+        fixed_palette.emplace_back(
+          rgb[0] / 255.0, rgb[1] / 255.0, rgb[2] / 255.0);
       }
       if (n <= fixed_palette.size()) {
         std::cerr << "Error: -n must be greater than number of fixed colors ("
@@ -385,13 +386,8 @@ main(int argc, char** argv)
     }
 
     if (input == "hex") {
-      for (const auto& color : values) {
-        if (!qualpal::isValidHexColor(color)) {
-          std::cerr << "Error: Invalid hex color '" << color
-                    << "'. Expected format: #RRGGBB or #RGB" << std::endl;
-          return 1;
-        }
-      }
+      // Parse up front so that errors refer to positions in the input
+      const auto hex_colors = qualpal::parseHexColors(values);
 
       if (do_extend) {
         // Filter out any fixed colors duplicated in candidates
@@ -401,13 +397,13 @@ main(int argc, char** argv)
           std::transform(s.begin(), s.end(), s.begin(), ::tolower);
           fixed_set.insert(s);
         }
-        std::vector<std::string> filtered;
+        std::vector<qualpal::colors::RGB> filtered;
         filtered.reserve(values.size());
-        for (auto s : values) {
-          std::string low = s;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+          std::string low = values[i];
           std::transform(low.begin(), low.end(), low.begin(), ::tolower);
           if (fixed_set.find(low) == fixed_set.end()) {
-            filtered.push_back(s);
+            filtered.push_back(hex_colors[i]);
           }
         }
         std::size_t needed_new = n - fixed_palette.size();
@@ -418,9 +414,9 @@ main(int argc, char** argv)
             << needed_new << ", have " << filtered.size() << ")" << std::endl;
           return 1;
         }
-        qp.setInputHex(filtered);
+        qp.setInputRGB(filtered);
       } else {
-        qp.setInputHex(values);
+        qp.setInputRGB(hex_colors);
       }
     } else if (input == "colorspace") {
       if (values.size() != 3) {
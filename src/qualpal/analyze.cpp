@@ -1,8 +1,34 @@
 #include "cvd.h"
 #include <algorithm>
 #include <qualpal/analyze.h>
+#include <qualpal/color_batch.h>
+#include <stdexcept>
 
 namespace qualpal {
+namespace {
+
+// Converts the colors straight into the batch layout used by the selected
+// metric.
+Matrix<double>
+differenceMatrix(const std::vector<colors::RGB>& rgb_colors,
+                 const metrics::MetricType& metric,
+                 double max_memory)
+{
+  switch (metric) {
+    case metrics::MetricType::DIN99d:
+      return colorDifferenceMatrix(
+        colors::DIN99dBatch(rgb_colors), metrics::DIN99d{}, max_memory);
+    case metrics::MetricType::CIEDE2000:
+      return colorDifferenceMatrix(
+        colors::LabBatch(rgb_colors), metrics::CIEDE2000{}, max_memory);
+    case metrics::MetricType::CIE76:
+      return colorDifferenceMatrix(
+        colors::LabBatch(rgb_colors), metrics::CIE76{}, max_memory);
+  }
+  throw std::invalid_argument("Unsupported metric type");
+}
+
+} // namespace
 
 PaletteAnalysisMap
 analyzePalette(const std::vector<colors::RGB>& colors,
@@ -21,23 +47,15 @@ analyzePalette(const std::vector<colors::RGB>& colors,
     std::optional<colors::RGB> simulated_bg = bg;
 
     if (cvd_type != "normal" && severity > 0.0) {
-      for (auto& rgb : simulated_colors) {
-        rgb = simulateCvd(rgb, cvd_type, severity);
-      }
+      const CvdSimulator simulator(cvd_type, severity);
+      simulated_colors = simulator.simulate(colors);
       if (simulated_bg.has_value()) {
-        simulated_bg = simulateCvd(*simulated_bg, cvd_type, severity);
+        simulated_bg = simulator.simulate(*simulated_bg);
       }
     }
 
-    std::vector<colors::XYZ> xyz_colors;
-    xyz_colors.reserve(simulated_colors.size());
-
-    for (const auto& rgb : simulated_colors) {
-      xyz_colors.emplace_back(rgb);
-    }
-
     Matrix<double> diff_matrix =
-      colorDifferenceMatrix(xyz_colors, metric, max_memory);
+      differenceMatrix(simulated_colors, metric, max_memory);
     std::vector<double> min_distances;
     min_distances.reserve(diff_matrix.nrow());
 
@@ -57,7 +75,8 @@ analyzePalette(const std::vector<colors::RGB>& colors,
     if (simulated_bg.has_value()) {
       colors::XYZ bg_xyz(*simulated_bg);
       double min_dist = std::numeric_limits<double>::max();
-      for (const auto& col : xyz_colors) {
+      for (const auto& rgb : simulated_colors) {
+        colors::XYZ col(rgb);
         double d = 0.0;
         switch (metric) {
           case metrics::MetricType::DIN99d:
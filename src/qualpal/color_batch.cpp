@@ -0,0 +1,322 @@
+#include "simd.h"
+#include <cmath>
+#include <qualpal/color_batch.h>
+
+namespace qualpal {
+namespace detail {
+
+namespace {
+
+// Same as the companding in colors.cpp.
+double
+inverseCompanding(const double v)
+{
+  return v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+}
+
+// Linearized values of the 256 8-bit sRGB component values.
+const std::array<double, 256>&
+inverseCompandingTable()
+{
+  static const std::array<double, 256> table = [] {
+    std::array<double, 256> t{};
+    for (int k = 0; k < 256; ++k) {
+      t[k] = inverseCompanding(k / 255.0);
+    }
+    return t;
+  }();
+  return table;
+}
+
+double
+linearize(const double v, const std::array<double, 256>& table)
+{
+  const long k = std::lround(v * 255.0);
+  if (k >= 0 && k <= 255 && k / 255.0 == v) {
+    return table[k];
+  }
+  return inverseCompanding(v);
+}
+
+// Mirrors the Lab(const XYZ&, white_point) constructor.
+QUALPAL_ALWAYS_INLINE void
+labFromXYZ(double x,
+           double y,
+           double z,
+           double wx,
+           double wy,
+           double wz,
+           double& l,
+           double& a,
+           double& b)
+{
+  constexpr double epsilon = 0.008856;
+  constexpr double kappa = 903.3;
+
+  const double xr = x / wx;
+  const double yr = y / wy;
+  const double zr = z / wz;
+
+  // Evaluate the cube root on both sides of the threshold, keeping its
+  // argument positive and normal.
+  const double cx = cbrtPositive(xr > epsilon ? xr : epsilon);
+  const double cy = cbrtPositive(yr > epsilon ? yr : epsilon);
+  const double cz = cbrtPositive(zr > epsilon ? zr : epsilon);
+
+  const double fx = xr > epsilon ? cx : (kappa * xr + 16.0) / 116.0;
+  const double fy = yr > epsilon ? cy : (kappa * yr + 16.0) / 116.0;
+  const double fz = zr > epsilon ? cz : (kappa * zr + 16.0) / 116.0;
+
+  const double l_raw = 116.0 * fy - 16.0;
+  const double a_raw = 500.0 * (fx - fy);
+  const double b_raw = 200.0 * (fy - fz);
+
+  l = l_raw < 0.0 ? 0.0 : (l_raw > 100.0 ? 100.0 : l_raw);
+  a = a_raw < -128.0 ? -128.0 : (a_raw > 127.0 ? 127.0 : a_raw);
+  b = b_raw < -128.0 ? -128.0 : (b_raw > 127.0 ? 127.0 : b_raw);
+}
+
+QUALPAL_TARGET_CLONES void
+xyzToLabKernel(const double* x,
+               const double* y,
+               const double* z,
+               std::size_t n,
+               double wx,
+               double wy,
+               double wz,
+               double* l,
+               double* a,
+               double* b)
+{
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t k = 0; k < n; ++k) {
+    double lk, ak, bk;
+    labFromXYZ(x[k], y[k], z[k], wx, wy, wz, lk, ak, bk);
+    l[k] = lk;
+    a[k] = ak;
+    b[k] = bk;
+  }
+}
+
+// Mirrors the XYZ(const Lab&, white_point) constructor, with the cubes
+// computed as products.
+QUALPAL_TARGET_CLONES void
+labToXYZKernel(const double* l,
+               const double* a,
+               const double* b,
+               std::size_t n,
+               double wx,
+               double wy,
+               double wz,
+               double* x,
+               double* y,
+               double* z)
+{
+  constexpr double epsilon = 216.0 / 24389.0;
+  constexpr double kappa = 24389.0 / 27.0;
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t k = 0; k < n; ++k) {
+    const double fy = (l[k] + 16.0) / 116.0;
+    const double fx = a[k] / 500.0 + fy;
+    const double fz = fy - b[k] / 200.0;
+    const double fx3 = fx * fx * fx;
+    const double fy3 = fy * fy * fy;
+    const double fz3 = fz * fz * fz;
+
+    const double xr = fx3 > epsilon ? fx3 : (116.0 * fx - 16.0) / kappa;
+    const double yr = l[k] > kappa * epsilon ? fy3 : l[k] / kappa;
+    const double zr = fz3 > epsilon ? fz3 : (116.0 * fz - 16.0) / kappa;
+
+    const double xk = xr * wx;
+    const double yk = yr * wy;
+    const double zk = zr * wz;
+    x[k] = xk > 0.0 ? xk : 0.0;
+    y[k] = yk > 0.0 ? yk : 0.0;
+    z[k] = zk > 0.0 ? zk : 0.0;
+  }
+}
+
+// Mirrors the DIN99d(const XYZ&, white_point) constructor. The hue rotation
+// by 50 degrees is applied to the unit vector (e, f) / g directly, which
+// avoids evaluating atan2(), cos() and sin().
+QUALPAL_TARGET_CLONES void
+xyzToDIN99dKernel(const double* x,
+                  const double* y,
+                  const double* z,
+                  std::size_t n,
+                  double wx,
+                  double wy,
+                  double wz,
+                  double cos_u,
+                  double sin_u,
+                  double* l,
+                  double* a,
+                  double* b)
+{
+  const double wx_prime = 1.12 * wx - 0.12 * wz;
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t k = 0; k < n; ++k) {
+    const double x_prime = 1.12 * x[k] - 0.12 * z[k];
+
+    double lab_l, lab_a, lab_b;
+    labFromXYZ(x_prime, y[k], z[k], wx_prime, wy, wz, lab_l, lab_a, lab_b);
+
+    const double e = lab_a * cos_u + lab_b * sin_u;
+    const double f = 1.14 * (lab_b * cos_u - lab_a * sin_u);
+    const double g = std::sqrt(e * e + f * f);
+
+    const double c99d = 22.5 * log1pNonNegative(0.06 * g);
+    const double scale = c99d / (g > 0.0 ? g : 1.0);
+
+    const double l_raw = 325.22 * log1pNonNegative(0.0036 * lab_l);
+    const double a_raw = scale * (e * cos_u - f * sin_u);
+    const double b_raw = scale * (f * cos_u + e * sin_u);
+
+    l[k] = l_raw < 0.0 ? 0.0 : (l_raw > 100.0 ? 100.0 : l_raw);
+    a[k] = a_raw < -128.0 ? -128.0 : (a_raw > 127.0 ? 127.0 : a_raw);
+    b[k] = b_raw < -128.0 ? -128.0 : (b_raw > 127.0 ? 127.0 : b_raw);
+  }
+}
+
+// Mirrors the RGB(const XYZ&) constructor.
+QUALPAL_TARGET_CLONES void
+xyzToRGBKernel(const double* x,
+               const double* y,
+               const double* z,
+               std::size_t n,
+               double* r,
+               double* g,
+               double* b)
+{
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t k = 0; k < n; ++k) {
+    const double xk = x[k];
+    const double yk = y[k];
+    const double zk = z[k];
+    const double r_lin = 3.2404542 * xk + -1.5371385 * yk + -0.4985314 * zk;
+    const double g_lin = -0.9692660 * xk + 1.8760108 * yk + 0.0415560 * zk;
+    const double b_lin = 0.0556434 * xk + -0.2040259 * yk + 1.0572252 * zk;
+    const double rk = compandSrgb(r_lin);
+    const double gk = compandSrgb(g_lin);
+    const double bk = compandSrgb(b_lin);
+    r[k] = rk < 0.0 ? 0.0 : (rk > 1.0 ? 1.0 : rk);
+    g[k] = gk < 0.0 ? 0.0 : (gk > 1.0 ? 1.0 : gk);
+    b[k] = bk < 0.0 ? 0.0 : (bk > 1.0 ? 1.0 : bk);
+  }
+}
+
+} // namespace
+
+void
+rgbToXYZ(const colors::RGB* rgb, std::size_t n, double* x, double* y, double* z)
+{
+  const auto& table = inverseCompandingTable();
+
+  for (std::size_t k = 0; k < n; ++k) {
+    const double r = linearize(rgb[k].r(), table);
+    const double g = linearize(rgb[k].g(), table);
+    const double b = linearize(rgb[k].b(), table);
+
+    // Same matrix and summation order as XYZ(const RGB&).
+    x[k] = 0.4124564 * r + 0.3575761 * g + 0.1804375 * b;
+    y[k] = 0.2126729 * r + 0.7151522 * g + 0.0721750 * b;
+    z[k] = 0.0193339 * r + 0.1191920 * g + 0.9503041 * b;
+  }
+}
+
+void
+xyzToRGB(const double* x,
+         const double* y,
+         const double* z,
+         std::size_t n,
+         double* r,
+         double* g,
+         double* b)
+{
+  xyzToRGBKernel(x, y, z, n, r, g, b);
+}
+
+void
+xyzToLab(const double* x,
+         const double* y,
+         const double* z,
+         std::size_t n,
+         const std::array<double, 3>& white_point,
+         double* l,
+         double* a,
+         double* b)
+{
+  xyzToLabKernel(
+    x, y, z, n, white_point[0], white_point[1], white_point[2], l, a, b);
+}
+
+void
+labToXYZ(const double* l,
+         const double* a,
+         const double* b,
+         std::size_t n,
+         const std::array<double, 3>& white_point,
+         double* x,
+         double* y,
+         double* z)
+{
+  labToXYZKernel(
+    l, a, b, n, white_point[0], white_point[1], white_point[2], x, y, z);
+}
+
+void
+xyzToDIN99d(const double* x,
+            const double* y,
+            const double* z,
+            std::size_t n,
+            const std::array<double, 3>& white_point,
+            double* l,
+            double* a,
+            double* b)
+{
+  const double u = 50 * M_PI / 180.0;
+  xyzToDIN99dKernel(x,
+                    y,
+                    z,
+                    n,
+                    white_point[0],
+                    white_point[1],
+                    white_point[2],
+                    std::cos(u),
+                    std::sin(u),
+                    l,
+                    a,
+                    b);
+}
+
+} // namespace detail
+
+namespace colors {
+
+std::vector<XYZ>
+toXYZ(const std::vector<RGB>& colors)
+{
+  const std::size_t n = colors.size();
+  AlignedVector x(n), y(n), z(n);
+  detail::rgbToXYZ(colors.data(), n, x.data(), y.data(), z.data());
+
+  std::vector<XYZ> result;
+  result.reserve(n);
+  for (std::size_t k = 0; k < n; ++k) {
+    result.emplace_back(x[k], y[k], z[k]);
+  }
+  return result;
+}
+
+} // namespace colors
+} // namespace qualpal
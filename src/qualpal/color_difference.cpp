@@ -1,9 +1,48 @@
+#include <qualpal/color_batch.h>
 #include <qualpal/color_difference.h>
 #include <qualpal/matrix.h>
 #include <qualpal/metrics.h>
 
 namespace qualpal {
 
+namespace {
+
+// Converts each view to the color space of the metric and computes the
+// minimum over views without going through vectors of color objects.
+template<typename ColorType, typename Metric>
+SymmetricMatrix<float>
+minViewDistances(const std::vector<std::vector<colors::XYZ>>& views,
+                 const Metric& metric,
+                 const double max_memory,
+                 const std::array<double, 3>& white_point)
+{
+  if (views.empty()) {
+    throw std::invalid_argument("At least one view is required to compute "
+                                "a color difference matrix.");
+  }
+
+  const std::size_t n_colors = views.front().size();
+
+  for (const auto& view : views) {
+    if (view.size() != n_colors) {
+      throw std::invalid_argument("All views must contain the same colors.");
+    }
+  }
+
+  detail::requireSymmetricMatrixSize<float>(n_colors, max_memory);
+
+  std::vector<detail::DistanceRows<ColorType, Metric>> rows;
+  rows.reserve(views.size());
+  for (const auto& view : views) {
+    rows.push_back(detail::makeDistanceRows(
+      colors::ColorBatch<ColorType>(view, white_point), metric));
+  }
+
+  return detail::minDistanceMatrix<float>(rows, n_colors);
+}
+
+} // namespace
+
 Matrix<double>
 colorDifferenceMatrix(const std::vector<colors::XYZ>& colors,
                       const metrics::MetricType& metric_type,
@@ -11,33 +50,69 @@ colorDifferenceMatrix(const std::vector<colors::XYZ>& colors,
                       const std::array<double, 3>& white_point)
 {
   switch (metric_type) {
-    case metrics::MetricType::DIN99d: {
-      std::vector<colors::DIN99d> din99d_colors;
-      din99d_colors.reserve(colors.size());
-      for (const auto& col : colors) {
-        din99d_colors.emplace_back(col, white_point);
-      }
+    case metrics::MetricType::DIN99d:
       return colorDifferenceMatrix(
-        din99d_colors, metrics::DIN99d{}, max_memory);
-    }
-    case metrics::MetricType::CIEDE2000: {
-      std::vector<colors::Lab> lab_colors;
-      lab_colors.reserve(colors.size());
-      for (const auto& col : colors) {
-        lab_colors.emplace_back(col, white_point);
-      }
+        colors::ColorBatch<colors::DIN99d>(colors, white_point),
+        metrics::DIN99d{},
+        max_memory);
+    case metrics::MetricType::CIEDE2000:
       return colorDifferenceMatrix(
-        lab_colors, metrics::CIEDE2000{}, max_memory);
-    }
-    case metrics::MetricType::CIE76: {
-      std::vector<colors::Lab> lab_colors;
-      lab_colors.reserve(colors.size());
-      for (const auto& col : colors) {
-        lab_colors.emplace_back(col, white_point);
-      }
-      return colorDifferenceMatrix(lab_colors, metrics::CIE76{}, max_memory);
-    }
+        colors::ColorBatch<colors::Lab>(colors, white_point),
+        metrics::CIEDE2000{},
+        max_memory);
+    case metrics::MetricType::CIE76:
+      return colorDifferenceMatrix(
+        colors::ColorBatch<colors::Lab>(colors, white_point),
+        metrics::CIE76{},
+        max_memory);
+  }
+  throw std::invalid_argument("Unsupported metric type");
+}
+
+SymmetricMatrix<float>
+symmetricColorDifferenceMatrix(const std::vector<colors::XYZ>& colors,
+                               const metrics::MetricType& metric_type,
+                               const double max_memory,
+                               const std::array<double, 3>& white_point)
+{
+  switch (metric_type) {
+    case metrics::MetricType::DIN99d:
+      return symmetricColorDifferenceMatrix(
+        colors::ColorBatch<colors::DIN99d>(colors, white_point),
+        metrics::DIN99d{},
+        max_memory);
+    case metrics::MetricType::CIEDE2000:
+      return symmetricColorDifferenceMatrix(
+        colors::ColorBatch<colors::Lab>(colors, white_point),
+        metrics::CIEDE2000{},
+        max_memory);
+    case metrics::MetricType::CIE76:
+      return symmetricColorDifferenceMatrix(
+        colors::ColorBatch<colors::Lab>(colors, white_point),
+        metrics::CIE76{},
+        max_memory);
   }
   throw std::invalid_argument("Unsupported metric type");
 }
+
+SymmetricMatrix<float>
+minColorDifferenceMatrix(const std::vector<std::vector<colors::XYZ>>& views,
+                         const metrics::MetricType& metric_type,
+                         const double max_memory,
+                         const std::array<double, 3>& white_point)
+{
+  switch (metric_type) {
+    case metrics::MetricType::DIN99d:
+      return minViewDistances<colors::DIN99d>(
+        views, metrics::DIN99d{}, max_memory, white_point);
+    case metrics::MetricType::CIEDE2000:
+      return minViewDistances<colors::Lab>(
+        views, metrics::CIEDE2000{}, max_memory, white_point);
+    case metrics::MetricType::CIE76:
+      return minViewDistances<colors::Lab>(
+        views, metrics::CIE76{}, max_memory, white_point);
+  }
+  throw std::invalid_argument("Unsupported metric type");
+}
+
 } // namespace qualpal
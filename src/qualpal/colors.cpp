@@ -1,4 +1,5 @@
 #include "math.h"
+#include "validation.h"
 #include <algorithm>
 #include <cassert>
 #include <cmath>
@@ -6,6 +7,7 @@
 #include <qualpal/colors.h>
 #include <qualpal/matrix.h>
 #include <sstream>
+#include <stdexcept>
 
 namespace qualpal {
 
@@ -54,56 +56,14 @@ RGB::RGB(const double r, const double g, const double b)
 
 RGB::RGB(const std::string& hex)
 {
-  std::stringstream ss;
-
-  int red = 0;
-  int green = 0;
-  int blue = 0;
-
-  // Assert that the string starts with '#'
-  assert(hex[0] == '#' && "Hex string must start with '#'");
-
-  // Assert that the string length is either 4 or 7
-  assert((hex.length() == 4 || hex.length() == 7) &&
-         "Hex string length be 4 or 7");
-
-  if (hex.length() == 4) {
-    ss << std::hex << hex.substr(1, 1) << hex.substr(1, 1);
-    ss >> red;
-
-    ss.clear();
-
-    ss << std::hex << hex.substr(2, 1) << hex.substr(2, 1);
-    ss >> green;
-
-    ss.clear();
-
-    ss << std::hex << hex.substr(3, 1) << hex.substr(3, 1);
-    ss >> blue;
-  } else if (hex.length() == 7) {
-    ss << std::hex << hex.substr(1, 2);
-    ss >> red;
-
-    ss.clear();
-
-    ss << std::hex << hex.substr(3, 2);
-    ss >> green;
-
-    ss.clear();
-
-    ss << std::hex << hex.substr(5, 2);
-    ss >> blue;
+  std::array<unsigned char, 3> rgb;
+  if (const auto error = parseHexColor(hex, rgb)) {
+    throw std::invalid_argument(hexColorErrorMessage(hex, *error));
   }
 
-  assert(red >= 0 && red <= 255 && "The red part of the hex string is valid");
-  assert(green >= 0 && green <= 255 &&
-         "The green part of the hex string is valid");
-  assert(blue >= 0 && blue <= 255 &&
-         "The blue part of the hex string is valid");
-
-  r_value = red / 255.0;
-  g_value = green / 255.0;
-  b_value = blue / 255.0;
+  r_value = rgb[0] / 255.0;
+  g_value = rgb[1] / 255.0;
+  b_value = rgb[2] / 255.0;
 }
 
 RGB::RGB(const HSL& hsl)
@@ -1,8 +1,15 @@
 #include "continuous_refinement.h"
 #include "cvd.h"
 #include <algorithm>
+#include <cassert>
 #include <limits>
+#include <qualpal/color_batch.h>
 #include <qualpal/metrics.h>
+#include <qualpal/threads.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace qualpal {
 namespace {
@@ -53,13 +60,9 @@ inRegions(const colors::Lab& lab,
 // out-of-gamut colors. Instead, compute the linear-sRGB matrix product
 // directly: companding is monotonic on [0,1] and maps the unit interval to
 // itself, so a color is in sRGB gamut iff every linear-RGB component is.
-bool
-inSrgbGamut(const colors::Lab& lab, const std::array<double, 3>& wp)
+inline bool
+inSrgbGamut(double x, double y, double z)
 {
-  colors::XYZ xyz(lab, wp);
-  const double x = xyz.x();
-  const double y = xyz.y();
-  const double z = xyz.z();
   const double r = 3.2404542 * x - 1.5371385 * y - 0.4985314 * z;
   const double g = -0.9692660 * x + 1.8760108 * y + 0.0415560 * z;
   const double b = 0.0556434 * x - 0.2040259 * y + 1.0572252 * z;
@@ -68,38 +71,578 @@ inSrgbGamut(const colors::Lab& lab, const std::array<double, 3>& wp)
          b >= -eps && b <= 1.0 + eps;
 }
 
-std::vector<colors::Lab>
-makeViews(const colors::XYZ& xyz,
+bool
+inSrgbGamut(const colors::Lab& lab, const std::array<double, 3>& wp)
+{
+  const colors::XYZ xyz(lab, wp);
+  return inSrgbGamut(xyz.x(), xyz.y(), xyz.z());
+}
+
+// A color as seen in each view: normal vision followed by one simulation per
+// active CVD type. Only three CVD types exist, so four views cover every
+// configuration and the views can be stored inline.
+constexpr std::size_t max_views = 4;
+using Views = std::array<colors::Lab, max_views>;
+
+// Buffers for computing the views of a block of colors. The caller fills
+// x, y, and z; the rest is working space.
+struct ViewScratch
+{
+  explicit ViewScratch(std::size_t n)
+    : x(n)
+    , y(n)
+    , z(n)
+    , r(n)
+    , g(n)
+    , b(n)
+    , cvd_x(n)
+    , cvd_y(n)
+    , cvd_z(n)
+    , lab_l(n)
+    , lab_a(n)
+    , lab_b(n)
+  {
+  }
+
+  colors::AlignedVector x, y, z;
+  colors::AlignedVector r, g, b;
+  colors::AlignedVector cvd_x, cvd_y, cvd_z;
+  colors::AlignedVector lab_l, lab_a, lab_b;
+};
+
+void
+storeView(const ViewScratch& s, std::size_t n, std::size_t v, Views* views)
+{
+  for (std::size_t k = 0; k < n; ++k) {
+    views[k][v] = colors::Lab(s.lab_l[k], s.lab_a[k], s.lab_b[k]);
+  }
+}
+
+// Views of the first `n` colors in `s.x`, `s.y`, and `s.z`. Each CVD view is
+// simulated and taken back to XYZ in one vectorized pass, so no intermediate
+// color objects are created.
+void
+makeViews(std::size_t n,
           const std::array<double, 3>& wp,
-          const std::map<std::string, double>& cvd)
+          const std::vector<CvdSimulator>& cvd,
+          ViewScratch& s,
+          Views* views)
 {
-  std::vector<colors::Lab> views;
-  views.reserve(1 + cvd.size());
-  views.emplace_back(xyz, wp);
-  if (!cvd.empty()) {
-    colors::RGB rgb(xyz);
-    for (const auto& [type, severity] : cvd) {
-      if (severity > 0.0) {
-        colors::RGB sim = simulateCvd(rgb, type, severity);
-        views.emplace_back(colors::Lab(colors::XYZ(sim), wp));
+  detail::xyzToLab(s.x.data(),
+                   s.y.data(),
+                   s.z.data(),
+                   n,
+                   wp,
+                   s.lab_l.data(),
+                   s.lab_a.data(),
+                   s.lab_b.data());
+  storeView(s, n, 0, views);
+  if (cvd.empty()) {
+    return;
+  }
+
+  detail::xyzToRGB(s.x.data(),
+                   s.y.data(),
+                   s.z.data(),
+                   n,
+                   s.r.data(),
+                   s.g.data(),
+                   s.b.data());
+  for (std::size_t v = 0; v < cvd.size(); ++v) {
+    cvd[v].simulateToXYZ(s.r.data(),
+                         s.g.data(),
+                         s.b.data(),
+                         n,
+                         s.cvd_x.data(),
+                         s.cvd_y.data(),
+                         s.cvd_z.data());
+    detail::xyzToLab(s.cvd_x.data(),
+                     s.cvd_y.data(),
+                     s.cvd_z.data(),
+                     n,
+                     wp,
+                     s.lab_l.data(),
+                     s.lab_a.data(),
+                     s.lab_b.data());
+    storeView(s, n, v + 1, views);
+  }
+}
+
+// Smallest difference, over all views, between a color and every palette
+// color except `skip`. `palette` holds one batch per view. Stops as soon as
+// the result cannot exceed `bound`.
+double
+minDistToPalette(const Views& views,
+                 const std::vector<colors::LabBatch>& palette,
+                 std::size_t skip,
+                 double bound,
+                 std::vector<double>& dist)
+{
+  metrics::CIEDE2000 dE;
+  double m = std::numeric_limits<double>::max();
+  for (std::size_t v = 0; v < palette.size(); ++v) {
+    dE.batch(views[v], palette[v], dist.data());
+    for (std::size_t j = 0; j < palette[v].size(); ++j) {
+      if (j != skip) {
+        m = std::min(m, dist[j]);
       }
     }
+    if (m <= bound) {
+      break;
+    }
   }
-  return views;
+  return m;
 }
 
+// Buffers for candidateMinDist(), one per thread.
+struct PairScratch
+{
+  explicit PairScratch(std::size_t n)
+    : lower(n)
+    , l(n)
+    , a(n)
+    , b(n)
+    , dist(n)
+  {
+  }
+
+  std::vector<double> lower;
+  std::vector<double> l, a, b;
+  std::vector<double> dist;
+};
+
+// Like minDistToPalette(), for a candidate that only matters if its result
+// exceeds `bound`. The result is the same when it does; otherwise it is some
+// value at most `bound`. For each view, only the palette colors whose lower
+// bounds (see metrics::CIEDE2000::lowerBound()) do not rule them out are
+// evaluated: first those that could bring the minimum down to `bound`, and,
+// if none does, those that could still lower the minimum.
 double
-minDistOverViews(const std::vector<colors::Lab>& a,
-                 const std::vector<colors::Lab>& b)
+candidateMinDist(const Views& views,
+                 const std::vector<colors::LabBatch>& palette,
+                 std::size_t skip,
+                 double bound,
+                 PairScratch& s)
 {
   metrics::CIEDE2000 dE;
   double m = std::numeric_limits<double>::max();
-  for (std::size_t k = 0; k < a.size(); ++k) {
-    m = std::min(m, dE(a[k], b[k]));
+  for (std::size_t v = 0; v < palette.size(); ++v) {
+    const colors::LabBatch& colors = palette[v];
+    const std::size_t n = colors.size();
+    dE.lowerBound(views[v], colors, s.lower.data());
+    s.lower[skip] = std::numeric_limits<double>::infinity();
+
+    for (const bool deciding : { true, false }) {
+      const double limit = deciding ? bound : m;
+      std::size_t n_pairs = 0;
+      for (std::size_t j = 0; j < n; ++j) {
+        const double lower = s.lower[j];
+        if (deciding ? lower <= limit : lower > bound && lower < limit) {
+          s.l[n_pairs] = colors.l()[j];
+          s.a[n_pairs] = colors.a()[j];
+          s.b[n_pairs] = colors.b()[j];
+          ++n_pairs;
+        }
+      }
+      dE.batch(views[v],
+               s.l.data(),
+               s.a.data(),
+               s.b.data(),
+               n_pairs,
+               s.dist.data());
+      for (std::size_t k = 0; k < n_pairs; ++k) {
+        m = std::min(m, s.dist[k]);
+      }
+      if (m <= bound) {
+        return m;
+      }
+    }
+  }
+  return m;
+}
+
+// Smallest difference between any two palette colors, over all views. Every
+// view of every color is needed, since the early exit of minDistToPalette()
+// would return a partial minimum once it reaches the running minimum.
+double
+paletteScore(const std::vector<colors::LabBatch>& palette,
+             std::vector<double>& dist)
+{
+  double m = std::numeric_limits<double>::max();
+  Views views;
+  for (std::size_t i = 0; i < palette.front().size(); ++i) {
+    for (std::size_t v = 0; v < palette.size(); ++v) {
+      views[v] = palette[v][i];
+    }
+    m = std::min(m,
+                 minDistToPalette(views,
+                                  palette,
+                                  i,
+                                  std::numeric_limits<double>::lowest(),
+                                  dist));
+  }
+  return m;
+}
+
+// Candidate positions for one color, scored by their minimum difference to
+// the rest of the palette. The buffers are allocated once, so that scoring
+// never touches the allocator.
+class CandidateSet
+{
+public:
+  CandidateSet(std::size_t capacity,
+               std::size_t n_total,
+               const std::vector<ColorspaceRegion>& regions,
+               ColorspaceType space,
+               const std::array<double, 3>& white_point,
+               const std::vector<CvdSimulator>& cvd)
+    : regions(regions)
+    , space(space)
+    , white_point(white_point)
+    , cvd(cvd)
+    , cand_l(capacity)
+    , cand_a(capacity)
+    , cand_b(capacity)
+    , cand_x(capacity)
+    , cand_y(capacity)
+    , cand_z(capacity)
+    , cand_ok(capacity)
+    , cand_index(capacity)
+    , cand_score(capacity)
+    , cand_views(capacity)
+    , scratch(capacity)
+    , pair_scratch(Threads::get(), PairScratch(n_total))
+  {
+  }
+
+  void clear() { n_cand = 0; }
+
+  void add(double l, double a, double b)
+  {
+    cand_l[n_cand] = l;
+    cand_a[n_cand] = a;
+    cand_b[n_cand] = b;
+    ++n_cand;
+  }
+
+  // Scores the candidates for color `i` and, if the best of them (the first
+  // in insertion order on ties) strictly beats `best_min`, moves `best_lab`
+  // and `best_views` there, updates `best_min`, and returns true. Candidates
+  // outside the L*a*b* bounds, the sRGB gamut, or the regions are skipped.
+  bool improve(std::size_t i,
+               const std::vector<colors::LabBatch>& palette,
+               colors::Lab& best_lab,
+               Views& best_views,
+               double& best_min)
+  {
+    // Bounds and gamut for all candidates at once, then the region test for
+    // the survivors. The batched conversion can differ from XYZ(const Lab&)
+    // in the last bits, which the gamut tolerance absorbs.
+    detail::labToXYZ(cand_l.data(),
+                     cand_a.data(),
+                     cand_b.data(),
+                     n_cand,
+                     white_point,
+                     cand_x.data(),
+                     cand_y.data(),
+                     cand_z.data());
+    for (std::size_t k = 0; k < n_cand; ++k) {
+      const double l = cand_l[k];
+      const double a = cand_a[k];
+      const double b = cand_b[k];
+      cand_ok[k] = l >= 0.0 && l <= 100.0 && a >= -128.0 && a <= 127.0 &&
+                   b >= -128.0 && b <= 127.0 &&
+                   inSrgbGamut(cand_x[k], cand_y[k], cand_z[k]);
+    }
+    if (!regions.empty()) {
+      for (std::size_t k = 0; k < n_cand; ++k) {
+        if (cand_ok[k]) {
+          cand_ok[k] = inRegions(
+            colors::Lab(cand_l[k], cand_a[k], cand_b[k]), regions, space);
+        }
+      }
+    }
+
+    // Views of the surviving candidates, in insertion order, computed as
+    // one block from exactly the XYZ value that is stored if the candidate
+    // wins.
+    std::size_t n_ok = 0;
+    for (std::size_t k = 0; k < n_cand; ++k) {
+      if (cand_ok[k]) {
+        const colors::XYZ xyz(colors::Lab(cand_l[k], cand_a[k], cand_b[k]),
+                              white_point);
+        scratch.x[n_ok] = xyz.x();
+        scratch.y[n_ok] = xyz.y();
+        scratch.z[n_ok] = xyz.z();
+        cand_index[n_ok] = k;
+        ++n_ok;
+      }
+    }
+    makeViews(n_ok, white_point, cvd, scratch, cand_views.data());
+    n_evaluations += n_ok;
+
+    // Score the candidates in parallel. Each thread scans a contiguous
+    // range in order and prunes against the best score it has seen, which
+    // never discards the first maximum, so the outcome matches a sequential
+    // scan for any number of threads.
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+    {
+      std::size_t thread = 0;
+#ifdef _OPENMP
+      thread = static_cast<std::size_t>(omp_get_thread_num());
+#endif
+      double bound = best_min;
+
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int j = 0; j < static_cast<int>(n_ok); ++j) {
+        const double m = candidateMinDist(
+          cand_views[j], palette, i, bound, pair_scratch[thread]);
+        cand_score[j] = m;
+        bound = std::max(bound, m);
+      }
+    }
+
+    std::size_t best_j = n_ok;
+    for (std::size_t j = 0; j < n_ok; ++j) {
+      if (cand_score[j] > best_min) {
+        best_min = cand_score[j];
+        best_j = j;
+      }
+    }
+    if (best_j == n_ok) {
+      return false;
+    }
+    const std::size_t k = cand_index[best_j];
+    best_lab = colors::Lab(cand_l[k], cand_a[k], cand_b[k]);
+    best_views = cand_views[best_j];
+    return true;
+  }
+
+  // Number of candidates scored so far
+  std::size_t evaluations() const { return n_evaluations; }
+
+private:
+  const std::vector<ColorspaceRegion>& regions;
+  ColorspaceType space;
+  const std::array<double, 3>& white_point;
+  const std::vector<CvdSimulator>& cvd;
+
+  std::size_t n_cand = 0;
+  std::size_t n_evaluations = 0;
+  std::vector<double> cand_l, cand_a, cand_b;
+  std::vector<double> cand_x, cand_y, cand_z;
+  std::vector<char> cand_ok;
+  std::vector<std::size_t> cand_index;
+  std::vector<double> cand_score;
+  std::vector<Views> cand_views;
+  ViewScratch scratch;
+  std::vector<PairScratch> pair_scratch;
+};
+
+// Coarse-to-fine grid: ΔE≈4 → ΔE≈1 → ΔE≈0.25, each a 7^3 cube around the
+// current best. Within a level, re-center on improvement and rescan.
+struct CubeLevel
+{
+  double radius;
+  int half;
+};
+constexpr std::array<CubeLevel, 3> cube_levels = {
+  { { 4.0, 3 }, { 1.0, 3 }, { 0.25, 3 } }
+};
+
+// Size of the largest cube, without its center
+constexpr std::size_t
+maxCubeCandidates()
+{
+  std::size_t m = 0;
+  for (const auto& level : cube_levels) {
+    const std::size_t side = 2 * level.half + 1;
+    m = std::max(m, side * side * side - 1);
   }
   return m;
 }
 
+// Moves `best_lab`, whose views are `best_views` and whose minimum difference
+// to the palette is `best_min`, to the best position found for color `i` by
+// scanning cubes of decreasing size.
+void
+cubeSearch(std::size_t i,
+           const std::vector<colors::LabBatch>& palette,
+           CandidateSet& candidates,
+           colors::Lab& best_lab,
+           Views& best_views,
+           double& best_min)
+{
+  for (const auto& level : cube_levels) {
+    const double step = level.radius / level.half;
+    bool level_changed = true;
+    while (level_changed) {
+      const colors::Lab center = best_lab;
+      candidates.clear();
+      for (int di = -level.half; di <= level.half; ++di) {
+        for (int dj = -level.half; dj <= level.half; ++dj) {
+          for (int dk = -level.half; dk <= level.half; ++dk) {
+            if (di == 0 && dj == 0 && dk == 0)
+              continue;
+            candidates.add(center.l() + di * step,
+                           center.a() + dj * step,
+                           center.b() + dk * step);
+          }
+        }
+      }
+      level_changed =
+        candidates.improve(i, palette, best_lab, best_views, best_min);
+    }
+  }
+}
+
+// Polling directions of the pattern search: the six coordinate directions
+// and the eight diagonals of the unit cube, which let the search follow the
+// ridges where two pairs of the palette are equally close.
+const std::array<std::array<double, 3>, 14> pattern_directions = { {
+  { 1, 0, 0 },
+  { -1, 0, 0 },
+  { 0, 1, 0 },
+  { 0, -1, 0 },
+  { 0, 0, 1 },
+  { 0, 0, -1 },
+  { 1, 1, 1 },
+  { 1, 1, -1 },
+  { 1, -1, 1 },
+  { 1, -1, -1 },
+  { -1, 1, 1 },
+  { -1, 1, -1 },
+  { -1, -1, 1 },
+  { -1, -1, -1 },
+} };
+
+// Like cubeSearch(), but polls only the pattern directions around the
+// current best and adapts the step: it grows after a successful poll and
+// shrinks after a failed one, and the search stops once the step is finer
+// than that of the finest cube.
+void
+patternSearch(std::size_t i,
+              const std::vector<colors::LabBatch>& palette,
+              CandidateSet& candidates,
+              colors::Lab& best_lab,
+              Views& best_views,
+              double& best_min)
+{
+  const CubeLevel& first = cube_levels.front();
+  const CubeLevel& last = cube_levels.back();
+  const double max_step = first.radius;
+  const double min_step = last.radius / last.half;
+
+  double step = first.radius / first.half;
+  while (step >= min_step) {
+    const colors::Lab center = best_lab;
+    candidates.clear();
+    for (const auto& d : pattern_directions) {
+      candidates.add(center.l() + d[0] * step,
+                     center.a() + d[1] * step,
+                     center.b() + d[2] * step);
+    }
+    if (candidates.improve(i, palette, best_lab, best_views, best_min)) {
+      step = std::min(2.0 * step, max_step);
+    } else {
+      step /= 2.0;
+    }
+  }
+}
+
+// Differences between every pair of palette colors, as the minimum over all
+// views, together with the nearest-neighbor difference of every color. The
+// smallest of those is the palette score, and the colors that attain it are
+// the endpoints of the bottleneck pairs. A pair is computed once and stored
+// for both colors, so that the nearest-neighbor differences of the two
+// endpoints are bitwise equal. After a move, only the row of the moved color
+// is recomputed, and another color's row is rescanned only when the moved
+// color was its nearest neighbor and has moved away.
+class PairDistances
+{
+public:
+  explicit PairDistances(const std::vector<colors::LabBatch>& palette)
+    : n(palette.front().size())
+    , pairs(n * n)
+    , nearest(n)
+    , dist(n)
+  {
+    for (std::size_t i = 0; i < n; ++i) {
+      computePairs(palette, i);
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+      computeNearest(j);
+    }
+  }
+
+  // Recompute the pairs of color `i` after it has moved.
+  void update(const std::vector<colors::LabBatch>& palette, std::size_t i)
+  {
+    old_row.assign(pairs.begin() + i * n, pairs.begin() + (i + 1) * n);
+    computePairs(palette, i);
+    computeNearest(i);
+    for (std::size_t j = 0; j < n; ++j) {
+      if (j == i) {
+        continue;
+      }
+      const double pair = pairs[i * n + j];
+      if (pair <= nearest[j]) {
+        nearest[j] = pair;
+      } else if (old_row[j] == nearest[j]) {
+        computeNearest(j);
+      }
+    }
+  }
+
+  double nearestTo(std::size_t i) const { return nearest[i]; }
+
+  double score() const
+  {
+    return *std::min_element(nearest.begin(), nearest.end());
+  }
+
+private:
+  void computePairs(const std::vector<colors::LabBatch>& palette,
+                    std::size_t i)
+  {
+    metrics::CIEDE2000 dE;
+    Views views;
+    for (std::size_t v = 0; v < palette.size(); ++v) {
+      views[v] = palette[v][i];
+    }
+    std::fill_n(pairs.begin() + i * n, n, std::numeric_limits<double>::max());
+    for (std::size_t v = 0; v < palette.size(); ++v) {
+      dE.batch(views[v], palette[v], dist.data());
+      for (std::size_t j = 0; j < n; ++j) {
+        pairs[i * n + j] = std::min(pairs[i * n + j], dist[j]);
+      }
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+      pairs[j * n + i] = pairs[i * n + j];
+    }
+  }
+
+  void computeNearest(std::size_t j)
+  {
+    nearest[j] = std::numeric_limits<double>::max();
+    for (std::size_t k = 0; k < n; ++k) {
+      if (k != j) {
+        nearest[j] = std::min(nearest[j], pairs[j * n + k]);
+      }
+    }
+  }
+
+  std::size_t n;
+  std::vector<double> pairs;
+  std::vector<double> nearest;
+  std::vector<double> dist;
+  std::vector<double> old_row;
+};
+
 } // namespace
 
 RefinementResult
@@ -109,7 +652,10 @@ refinePalette(std::vector<colors::XYZ> selected,
               const std::vector<ColorspaceRegion>& regions,
               ColorspaceType space,
               const std::array<double, 3>& white_point,
-              const std::map<std::string, double>& cvd)
+              const std::vector<CvdSimulator>& cvd,
+              double best_score,
+              RefinementStrategy strategy,
+              LocalSearch local_search)
 {
   const std::size_t n_total = selected.size();
   const std::size_t movable_end = n_total - (has_bg ? 1 : 0);
@@ -118,107 +664,176 @@ refinePalette(std::vector<colors::XYZ> selected,
     return { std::move(selected), std::move(moved) };
   }
 
-  std::vector<std::vector<colors::Lab>> views(n_total);
-  for (std::size_t i = 0; i < n_total; ++i) {
-    views[i] = makeViews(selected[i], white_point, cvd);
-  }
+  // Every color is seen in the same views, so the palette is stored as one
+  // batch per view for the vectorized metric.
+  const std::size_t n_views = 1 + cvd.size();
+  assert(n_views <= max_views && "At most three CVD types are supported");
+  std::vector<colors::LabBatch> palette(n_views);
+  std::vector<double> dist(n_total);
 
-  // Coarse-to-fine grid: ΔE≈4 → ΔE≈1 → ΔE≈0.25, each a 7^3 cube around the
-  // current best. Within a level, re-center on improvement and rescan.
-  struct Level
   {
-    double radius;
-    int half;
+    ViewScratch scratch(n_total);
+    std::vector<Views> views(n_total);
+    for (std::size_t i = 0; i < n_total; ++i) {
+      scratch.x[i] = selected[i].x();
+      scratch.y[i] = selected[i].y();
+      scratch.z[i] = selected[i].z();
+    }
+    makeViews(n_total, white_point, cvd, scratch, views.data());
+    for (std::size_t i = 0; i < n_total; ++i) {
+      for (std::size_t v = 0; v < n_views; ++v) {
+        palette[v].push_back(views[i][v]);
+      }
+    }
+  }
+
+  CandidateSet candidates(std::max(maxCubeCandidates(),
+                                   pattern_directions.size()),
+                          n_total,
+                          regions,
+                          space,
+                          white_point,
+                          cvd);
+
+  // Searches around color `i` and moves it if that strictly increases its
+  // minimum difference to the rest of the palette, which is `current_min`.
+  // Returns whether the color moved.
+  auto improve = [&](std::size_t i, double current_min) {
+    colors::Lab best_lab(selected[i], white_point);
+    Views best_views;
+    for (std::size_t v = 0; v < n_views; ++v) {
+      best_views[v] = palette[v][i];
+    }
+    double best_min = current_min;
+    if (local_search == LocalSearch::Pattern) {
+      patternSearch(i, palette, candidates, best_lab, best_views, best_min);
+    } else {
+      cubeSearch(i, palette, candidates, best_lab, best_views, best_min);
+    }
+    if (best_min <= current_min) {
+      return false;
+    }
+    selected[i] = colors::XYZ(best_lab, white_point);
+    for (std::size_t v = 0; v < n_views; ++v) {
+      palette[v].set(i, best_views[v]);
+    }
+    moved[i] = true;
+    return true;
   };
-  const std::array<Level, 3> levels = {
-    { { 4.0, 3 }, { 1.0, 3 }, { 0.25, 3 } }
+
+  // The candidate sampler can yield colors whose RGB round-trip lands
+  // outside the user's region; skip those rather than fight a no-win
+  // strict-improvement search.
+  auto searchable = [&](std::size_t i) {
+    const colors::Lab lab(selected[i], white_point);
+    return inRegions(lab, regions, space) && inSrgbGamut(lab, white_point);
   };
 
+  // Whether to give up on beating `best_score`, given the score before and
+  // after a pass.
+  const std::size_t max_passes = 8;
+  const bool can_abandon = best_score > std::numeric_limits<double>::lowest();
+  auto fallsBehind = [&](double previous, double score, std::size_t pass) {
+    const double remaining = static_cast<double>(max_passes - pass);
+    const double slack =
+      std::max(2.0 * remaining * (score - previous), 0.02 * best_score);
+    return score + slack < best_score;
+  };
+
+  if (strategy == RefinementStrategy::Bottleneck) {
+    // Only the endpoints of the bottleneck pairs are searched, in increasing
+    // index order, until none of them can move. A move strictly increases
+    // the nearest-neighbor difference of the color, so the score never
+    // decreases. The search budget matches that of the sweep, and a pass is
+    // counted for every `n_movable` searches.
+    const std::size_t n_movable = movable_end - n_fixed;
+    PairDistances pairs(palette);
+    std::vector<char> unsearchable(n_total, 0);
+    for (std::size_t i = n_fixed; i < movable_end; ++i) {
+      unsearchable[i] = !searchable(i);
+    }
+    std::vector<char> stuck = unsearchable;
+
+    double pass_start = pairs.score();
+    for (std::size_t n_searches = 0; n_searches < max_passes * n_movable;
+         ++n_searches) {
+      if (can_abandon && n_searches > 0 && n_searches % n_movable == 0) {
+        const double previous = pass_start;
+        pass_start = pairs.score();
+        if (fallsBehind(previous, pass_start, n_searches / n_movable)) {
+          return { std::move(selected),
+                   std::move(moved),
+                   pass_start,
+                   true,
+                   candidates.evaluations() };
+        }
+      }
+
+      const double score = pairs.score();
+      std::size_t i = n_fixed;
+      while (i < movable_end && (stuck[i] || pairs.nearestTo(i) > score)) {
+        ++i;
+      }
+      if (i == movable_end) {
+        break;
+      }
+
+      if (improve(i, pairs.nearestTo(i))) {
+        pairs.update(palette, i);
+        // The move changes what the other endpoints can reach.
+        stuck = unsearchable;
+      } else {
+        stuck[i] = 1;
+      }
+    }
+
+    return { std::move(selected),
+             std::move(moved),
+             paletteScore(palette, dist),
+             false,
+             candidates.evaluations() };
+  }
+
   bool any_changed = true;
   std::size_t pass = 0;
-  const std::size_t max_passes = 8;
+  double score = paletteScore(palette, dist);
 
   while (any_changed && pass < max_passes) {
+    if (pass > 0 && can_abandon) {
+      const double previous = score;
+      score = paletteScore(palette, dist);
+      if (fallsBehind(previous, score, pass)) {
+        return { std::move(selected),
+                 std::move(moved),
+                 score,
+                 true,
+                 candidates.evaluations() };
+      }
+    }
+
     any_changed = false;
     ++pass;
 
     for (std::size_t i = n_fixed; i < movable_end; ++i) {
-      colors::Lab best_lab(selected[i], white_point);
-      // The candidate sampler can yield colors whose RGB round-trip lands
-      // outside the user's region; skip those rather than fight a no-win
-      // strict-improvement search.
-      if (!inRegions(best_lab, regions, space) ||
-          !inSrgbGamut(best_lab, white_point)) {
+      if (!searchable(i)) {
         continue;
       }
-      double current_min = std::numeric_limits<double>::max();
-      for (std::size_t j = 0; j < n_total; ++j) {
-        if (j == i)
-          continue;
-        current_min =
-          std::min(current_min, minDistOverViews(views[i], views[j]));
-      }
-
-      double best_min = current_min;
-      std::vector<colors::Lab> best_views = views[i];
-
-      for (const auto& level : levels) {
-        const double step = level.radius / level.half;
-        bool level_changed = true;
-        while (level_changed) {
-          level_changed = false;
-          colors::Lab center = best_lab;
-          for (int di = -level.half; di <= level.half; ++di) {
-            for (int dj = -level.half; dj <= level.half; ++dj) {
-              for (int dk = -level.half; dk <= level.half; ++dk) {
-                if (di == 0 && dj == 0 && dk == 0)
-                  continue;
-                double cand_l = center.l() + di * step;
-                double cand_a = center.a() + dj * step;
-                double cand_b = center.b() + dk * step;
-                if (cand_l < 0.0 || cand_l > 100.0)
-                  continue;
-                if (cand_a < -128.0 || cand_a > 127.0)
-                  continue;
-                if (cand_b < -128.0 || cand_b > 127.0)
-                  continue;
-                colors::Lab cand(cand_l, cand_a, cand_b);
-                if (!inSrgbGamut(cand, white_point))
-                  continue;
-                if (!inRegions(cand, regions, space))
-                  continue;
-                colors::XYZ cand_xyz(cand, white_point);
-                auto cand_views = makeViews(cand_xyz, white_point, cvd);
-                double m = std::numeric_limits<double>::max();
-                for (std::size_t j = 0; j < n_total; ++j) {
-                  if (j == i)
-                    continue;
-                  m = std::min(m, minDistOverViews(cand_views, views[j]));
-                  if (m <= best_min)
-                    break;
-                }
-                if (m > best_min) {
-                  best_min = m;
-                  best_lab = cand;
-                  best_views = std::move(cand_views);
-                  level_changed = true;
-                }
-              }
-            }
-          }
-        }
-      }
-
-      if (best_min > current_min) {
-        selected[i] = colors::XYZ(best_lab, white_point);
-        views[i] = std::move(best_views);
-        moved[i] = true;
-        any_changed = true;
+      Views views;
+      for (std::size_t v = 0; v < n_views; ++v) {
+        views[v] = palette[v][i];
       }
+      const double current_min = minDistToPalette(
+        views, palette, i, std::numeric_limits<double>::lowest(), dist);
+      any_changed = improve(i, current_min) || any_changed;
     }
   }
 
-  return { std::move(selected), std::move(moved) };
+  score = paletteScore(palette, dist);
+  return { std::move(selected),
+           std::move(moved),
+           score,
+           false,
+           candidates.evaluations() };
 }
 
 } // namespace qualpal
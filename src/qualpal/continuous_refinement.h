@@ -1,7 +1,8 @@
 #pragma once
 
+#include "cvd.h"
 #include <array>
-#include <map>
+#include <limits>
 #include <qualpal/colors.h>
 #include <qualpal/qualpal.h>
 #include <string>
@@ -15,6 +16,10 @@ namespace qualpal {
 // any active CVD simulation). Strict-improvement is required, so the same
 // monotonicity argument as the swap loop guarantees no cycles.
 //
+// `cvd` holds one simulator per active color vision deficiency.
+// `strategy` selects the points to search around (see RefinementStrategy)
+// and `local_search` how each search proceeds (see LocalSearch).
+//
 // `selected` layout:
 //   [0, n_fixed)                          fixed colors, never moved
 //   [n_fixed, selected.size() - has_bg)   movable colors
@@ -26,11 +31,25 @@ namespace qualpal {
 //
 // Returns the refined XYZ vector plus a `moved` mask: callers should replace
 // the original RGB only for moved entries, since the XYZ→RGB roundtrip on
-// unchanged out-of-gamut colors is not always the identity.
+// unchanged out-of-gamut colors is not always the identity. `score` is the
+// smallest difference between any two colors of the refined palette, over
+// all views. `evaluations` is the number of candidate positions that were
+// scored, which is also set for abandoned refinements.
+//
+// The refinement is abandoned (`abandoned` is set and the other fields are
+// unspecified) once it is unlikely to beat `best_score`. After every pass,
+// the reachable score is estimated by extrapolating twice the gain of that
+// pass over the remaining passes, and by at least 2% of `best_score`. The
+// estimate is a heuristic: gains usually shrink from pass to pass, but a
+// seed that stalls and then recovers can be cut short, so callers only pass
+// a finite `best_score` when the user has opted in.
 struct RefinementResult
 {
   std::vector<colors::XYZ> selected;
   std::vector<bool> moved;
+  double score = 0.0;
+  bool abandoned = false;
+  std::size_t evaluations = 0;
 };
 
 RefinementResult
@@ -40,6 +59,9 @@ refinePalette(std::vector<colors::XYZ> selected,
               const std::vector<ColorspaceRegion>& regions,
               ColorspaceType space,
               const std::array<double, 3>& white_point,
-              const std::map<std::string, double>& cvd);
+              const std::vector<CvdSimulator>& cvd,
+              double best_score = -std::numeric_limits<double>::infinity(),
+              RefinementStrategy strategy = RefinementStrategy::Sweep,
+              LocalSearch local_search = LocalSearch::Cube);
 
 } // namespace qualpal
@@ -1,7 +1,9 @@
 #include "cvd.h"
+#include "simd.h"
 #include <algorithm>
 #include <cmath>
 #include <qualpal/matrix.h>
+#include <stdexcept>
 
 namespace qualpal {
 
@@ -113,15 +115,54 @@ constexpr std::array<FixedMatrix<double, 3, 3>, 11> TRITAN_MATRICES = {
       { 0.004733, 0.691367, 0.303900 } } }
 };
 
-colors::RGB
-simulateCvd(const colors::RGB& rgb,
-            const std::string_view cvd_type,
-            double cvd_severity)
+namespace {
+
+QUALPAL_TARGET_CLONES void
+simulateToXYZKernel(const double* m,
+                    const double* r,
+                    const double* g,
+                    const double* b,
+                    std::size_t n,
+                    double* x,
+                    double* y,
+                    double* z)
 {
-  cvd_severity *= 10;
+  const double m00 = m[0], m01 = m[1], m02 = m[2];
+  const double m10 = m[3], m11 = m[4], m12 = m[5];
+  const double m20 = m[6], m21 = m[7], m22 = m[8];
 
-  int fl = static_cast<int>(std::floor(cvd_severity));
-  int ce = static_cast<int>(std::ceil(cvd_severity));
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t i = 0; i < n; ++i) {
+    const double ri = r[i];
+    const double gi = g[i];
+    const double bi = b[i];
+    double rs = m00 * ri + m01 * gi + m02 * bi;
+    double gs = m10 * ri + m11 * gi + m12 * bi;
+    double bs = m20 * ri + m21 * gi + m22 * bi;
+    rs = rs < 0.0 ? 0.0 : (rs > 1.0 ? 1.0 : rs);
+    gs = gs < 0.0 ? 0.0 : (gs > 1.0 ? 1.0 : gs);
+    bs = bs < 0.0 ? 0.0 : (bs > 1.0 ? 1.0 : bs);
+
+    const double r_lin = detail::linearizeSrgb(rs);
+    const double g_lin = detail::linearizeSrgb(gs);
+    const double b_lin = detail::linearizeSrgb(bs);
+
+    // Same matrix as XYZ(const RGB&).
+    x[i] = 0.4124564 * r_lin + 0.3575761 * g_lin + 0.1804375 * b_lin;
+    y[i] = 0.2126729 * r_lin + 0.7151522 * g_lin + 0.0721750 * b_lin;
+    z[i] = 0.0193339 * r_lin + 0.1191920 * g_lin + 0.9503041 * b_lin;
+  }
+}
+
+} // namespace
+
+CvdSimulator::CvdSimulator(std::string_view cvd_type, double cvd_severity)
+{
+  if (cvd_severity < 0.0 || cvd_severity > 1.0) {
+    throw std::invalid_argument("cvd_severity must be between 0 and 1");
+  }
 
   const std::array<FixedMatrix<double, 3, 3>, 11>* cvd_mats = nullptr;
 
@@ -131,22 +172,103 @@ simulateCvd(const colors::RGB& rgb,
     cvd_mats = &DEUTAN_MATRICES;
   } else if (cvd_type == "tritan") {
     cvd_mats = &TRITAN_MATRICES;
-  };
+  } else {
+    throw std::invalid_argument(
+      "Invalid CVD type: " + std::string(cvd_type) +
+      ". Supported types are: protan, deutan, tritan.");
+  }
+
+  cvd_severity *= 10;
+
+  int fl = static_cast<int>(std::floor(cvd_severity));
+  int ce = static_cast<int>(std::ceil(cvd_severity));
 
   const FixedMatrix<double, 3, 3>& cvd_mat_lo = (*cvd_mats)[fl];
   const FixedMatrix<double, 3, 3>& cvd_mat_hi = (*cvd_mats)[ce];
 
   // interpolate cvd matrix
-  FixedMatrix<double, 3, 3> cvd_mat =
-    cvd_mat_lo +
-    (cvd_mat_hi - cvd_mat_lo) * (cvd_severity - static_cast<double>(fl));
+  matrix = cvd_mat_lo +
+           (cvd_mat_hi - cvd_mat_lo) * (cvd_severity - static_cast<double>(fl));
+}
 
+colors::RGB
+CvdSimulator::simulate(const colors::RGB& rgb) const
+{
   std::array<double, 3> rgb_vec = { rgb.r(), rgb.g(), rgb.b() };
-  std::array<double, 3> rgb_cvd = cvd_mat * rgb_vec;
+  std::array<double, 3> rgb_cvd = matrix * rgb_vec;
 
   return { std::clamp(rgb_cvd[0], 0.0, 1.0),
            std::clamp(rgb_cvd[1], 0.0, 1.0),
            std::clamp(rgb_cvd[2], 0.0, 1.0) };
 }
 
+std::vector<colors::RGB>
+CvdSimulator::simulate(const std::vector<colors::RGB>& rgb) const
+{
+  std::vector<colors::RGB> result;
+  result.reserve(rgb.size());
+  for (const auto& color : rgb) {
+    result.push_back(simulate(color));
+  }
+  return result;
+}
+
+void
+CvdSimulator::simulate(const double* r,
+                       const double* g,
+                       const double* b,
+                       std::size_t n,
+                       double* r_out,
+                       double* g_out,
+                       double* b_out) const
+{
+  const double m00 = matrix(0, 0), m01 = matrix(0, 1), m02 = matrix(0, 2);
+  const double m10 = matrix(1, 0), m11 = matrix(1, 1), m12 = matrix(1, 2);
+  const double m20 = matrix(2, 0), m21 = matrix(2, 1), m22 = matrix(2, 2);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const double ri = r[i];
+    const double gi = g[i];
+    const double bi = b[i];
+    r_out[i] = std::clamp(m00 * ri + m01 * gi + m02 * bi, 0.0, 1.0);
+    g_out[i] = std::clamp(m10 * ri + m11 * gi + m12 * bi, 0.0, 1.0);
+    b_out[i] = std::clamp(m20 * ri + m21 * gi + m22 * bi, 0.0, 1.0);
+  }
+}
+
+void
+CvdSimulator::simulateToXYZ(const double* r,
+                            const double* g,
+                            const double* b,
+                            std::size_t n,
+                            double* x,
+                            double* y,
+                            double* z) const
+{
+  const double m[9] = { matrix(0, 0), matrix(0, 1), matrix(0, 2),
+                        matrix(1, 0), matrix(1, 1), matrix(1, 2),
+                        matrix(2, 0), matrix(2, 1), matrix(2, 2) };
+  simulateToXYZKernel(m, r, g, b, n, x, y, z);
+}
+
+std::vector<CvdSimulator>
+cvdSimulators(const std::map<std::string, double>& cvd)
+{
+  std::vector<CvdSimulator> simulators;
+  for (const auto& [cvd_type, cvd_severity] : cvd) {
+    if (cvd_severity > 0.0) {
+      simulators.emplace_back(cvd_type, cvd_severity);
+    }
+  }
+  return simulators;
+}
+
+colors::RGB
+simulateCvd(const colors::RGB& rgb,
+            const std::string_view cvd_type,
+            double cvd_severity)
+{
+  return CvdSimulator(cvd_type, cvd_severity).simulate(rgb);
+}
+
 } // namespace qualpal
@@ -1,9 +1,57 @@
+#pragma once
+
 #include <cmath>
+#include <map>
 #include <qualpal/colors.h>
+#include <qualpal/matrix.h>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace qualpal {
 
+// Simulates one color vision deficiency at a fixed severity. The simulation
+// matrix is looked up and interpolated once on construction, so simulating a
+// color afterwards is a single matrix product.
+class CvdSimulator
+{
+public:
+  // Throws std::invalid_argument for an unknown type or a severity outside
+  // [0, 1].
+  CvdSimulator(std::string_view cvd_type, double cvd_severity);
+
+  colors::RGB simulate(const colors::RGB& rgb) const;
+
+  std::vector<colors::RGB> simulate(const std::vector<colors::RGB>& rgb) const;
+
+  // Structure-of-arrays version. The outputs may alias the inputs.
+  void simulate(const double* r,
+                const double* g,
+                const double* b,
+                std::size_t n,
+                double* r_out,
+                double* g_out,
+                double* b_out) const;
+
+  // Simulates companded sRGB components and converts the result straight to
+  // XYZ. The clamp, linearization and RGB to XYZ matrix are fused into the
+  // same vectorized pass, so no RGB or XYZ objects are created.
+  void simulateToXYZ(const double* r,
+                     const double* g,
+                     const double* b,
+                     std::size_t n,
+                     double* x,
+                     double* y,
+                     double* z) const;
+
+private:
+  FixedMatrix<double, 3, 3> matrix;
+};
+
+// One simulator per CVD type with a positive severity, in map order.
+std::vector<CvdSimulator>
+cvdSimulators(const std::map<std::string, double>& cvd);
+
 colors::RGB
 simulateCvd(const colors::RGB& rgb,
             const std::string_view cvd_type,
@@ -1,163 +1,770 @@
-#include "farthest_points.h"
-#include "cvd.h"
-#include <algorithm>
-#include <limits>
-#include <numeric>
-#include <qualpal/threads.h>
-
-namespace qualpal {
-
-std::vector<std::size_t>
-farthestPoints(const std::size_t n,
-               const std::vector<colors::XYZ>& colors,
-               const metrics::MetricType& metric_type,
-               const bool has_bg,
-               const std::size_t n_fixed,
-               const double max_memory,
-               const std::array<double, 3>& white_point,
-               const std::map<std::string, double>& cvd)
-{
-  // Start with normal vision distances
-  Matrix<double> dist_mat =
-    colorDifferenceMatrix(colors, metric_type, max_memory, white_point);
-
-  // For each CVD type, compute distances and take element-wise minimum
-  for (const auto& [cvd_type, cvd_severity] : cvd) {
-    if (cvd_severity > 0.0) {
-      std::vector<colors::RGB> rgb_cvd;
-      rgb_cvd.reserve(colors.size());
-      for (const auto& xyz : colors) {
-        colors::RGB rgb(xyz);
-        rgb_cvd.push_back(simulateCvd(rgb, cvd_type, cvd_severity));
-      }
-
-      // Convert back to XYZ
-      std::vector<colors::XYZ> xyz_cvd;
-      xyz_cvd.reserve(rgb_cvd.size());
-      for (const auto& rgb : rgb_cvd) {
-        xyz_cvd.emplace_back(rgb);
-      }
-
-      // Compute distance matrix for this CVD simulation
-      Matrix<double> cvd_dist_mat =
-        colorDifferenceMatrix(xyz_cvd, metric_type, max_memory, white_point);
-
-      // Take element-wise minimum with existing matrix
-#ifdef _OPENMP
-#pragma omp parallel for num_threads(Threads::get())
-#endif
-      for (int i = 0; i < static_cast<int>(dist_mat.nrow()); ++i) {
-#ifdef _OPENMP
-#pragma omp simd
-#endif
-        for (int j = 0; j < static_cast<int>(dist_mat.ncol()); ++j) {
-          dist_mat(i, j) = std::min(dist_mat(i, j), cvd_dist_mat(i, j));
-        }
-      }
-    }
-  }
-
-  const std::size_t n_candidates = colors.size() - n_fixed - (has_bg ? 1 : 0);
-  const std::size_t n_colors = colors.size();
-
-  if (n - n_fixed > n_candidates) {
-    throw std::invalid_argument(
-      "Requested number of new colors exceeds candidate pool.");
-  }
-
-  // Begin with the fixed points, then fill up to n with new points.
-  std::vector<std::size_t> r(n);
-  std::iota(r.begin(), r.end(), 0);
-
-  // Store the complement to r (excluding fixed points).
-  std::vector<std::size_t> r_c(colors.size() - n);
-  std::iota(r_c.begin(), r_c.end(), n);
-
-  bool set_changed = true;
-
-  while (set_changed) {
-    set_changed = false;
-
-    for (std::size_t i = n_fixed; i < n; ++i) {
-      std::size_t ind_new = i;
-
-      double min_dist_old = std::numeric_limits<double>::max();
-
-      // Find the distance between the current point and the others in the
-      // currently selected set (r).
-      for (std::size_t j = 0; j < n; ++j) {
-        assert(r[j] < n_colors && "Index out of bounds in r[j]");
-        if (j != i) {
-          min_dist_old = std::min(min_dist_old, dist_mat(r[j], r[i]));
-        }
-      }
-
-      if (has_bg) {
-        min_dist_old = std::min(min_dist_old, dist_mat(r[i], n_colors - 1));
-      }
-
-      bool found_better = false;
-
-      // Check if any point in the complement set (r_c) has a greater minimum
-      // distance to the points currently selected (r).
-      for (std::size_t k = 0; k < r_c.size(); ++k) {
-        double min_dist_k = std::numeric_limits<double>::max();
-
-        for (std::size_t j = 0; j < n; ++j) {
-          if (j != i) {
-            double d = dist_mat(r[j], r_c[k]);
-            min_dist_k = std::min(min_dist_k, d);
-          }
-        }
-
-        if (has_bg) {
-          min_dist_k = std::min(min_dist_k, dist_mat(r_c[k], n_colors - 1));
-        }
-
-        if (min_dist_k > min_dist_old) {
-          min_dist_old = min_dist_k;
-          ind_new = k;
-          found_better = true;
-        }
-      }
-
-      // If we have found a better point in r_c, swap places with the current
-      // point.
-      if (found_better) {
-        std::swap(r[i], r_c[ind_new]);
-        set_changed = true;
-      }
-    }
-  }
-
-  for (std::size_t i = n_fixed; i < n; ++i) {
-    assert(r[i] >= n_fixed &&
-           "Non-candidate index found in candidate selection!");
-  }
-
-  // Arrange the colors in the palette according to how distinct they are from
-  // one another.
-  std::sort(r.begin() + n_fixed,
-            r.end(),
-            [&dist_mat, &r, n_fixed](std::size_t a, std::size_t b) {
-              double min_dist_a = std::numeric_limits<double>::max();
-              double min_dist_b = std::numeric_limits<double>::max();
-
-              for (size_t i = 0; i < r.size(); ++i) {
-                if (i >= n_fixed) {
-                  if (r[i] != a) {
-                    min_dist_a = std::min(min_dist_a, dist_mat(r[i], a));
-                  }
-                  if (r[i] != b) {
-                    min_dist_b = std::min(min_dist_b, dist_mat(r[i], b));
-                  }
-                }
-              }
-
-              return min_dist_a > min_dist_b;
-            });
-
-  return r;
-}
-
-} // namespace qualpal
+#include "farthest_points.h"
+#include "cvd.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <qualpal/color_batch.h>
+#include <qualpal/threads.h>
+#include <stdexcept>
+
+namespace qualpal {
+
+namespace {
+
+// The colors under normal vision, followed by one simulated copy per active
+// CVD type. Distances are the minimum over these views.
+std::vector<std::vector<colors::XYZ>>
+cvdViews(const std::vector<colors::XYZ>& colors,
+         const std::map<std::string, double>& cvd)
+{
+  std::vector<std::vector<colors::XYZ>> views;
+  views.push_back(colors);
+
+  const auto simulators = cvdSimulators(cvd);
+  if (simulators.empty()) {
+    return views;
+  }
+
+  const std::size_t n = colors.size();
+  colors::AlignedVector x(n), y(n), z(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = colors[i].x();
+    y[i] = colors[i].y();
+    z[i] = colors[i].z();
+  }
+
+  colors::AlignedVector r(n), g(n), b(n);
+  detail::xyzToRGB(
+    x.data(), y.data(), z.data(), n, r.data(), g.data(), b.data());
+
+  for (const auto& simulator : simulators) {
+    simulator.simulateToXYZ(
+      r.data(), g.data(), b.data(), n, x.data(), y.data(), z.data());
+
+    std::vector<colors::XYZ> view;
+    view.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      view.emplace_back(x[i], y[i], z[i]);
+    }
+    views.push_back(std::move(view));
+  }
+
+  return views;
+}
+
+// Distances looked up in the packed color difference matrix. Each slot of the
+// selection (plus the background, if any) maps to a column.
+class DenseDistances
+{
+public:
+  DenseDistances(const SymmetricMatrix<float>& dist_mat, std::size_t n_slots)
+    : dist_mat(dist_mat)
+    , index(n_slots)
+  {
+  }
+
+  void assign(std::size_t slot, std::size_t i) { index[slot] = i; }
+
+  double operator()(std::size_t slot, std::size_t j) const
+  {
+    return dist_mat(j, index[slot]);
+  }
+
+private:
+  const SymmetricMatrix<float>& dist_mat;
+  std::vector<std::size_t> index;
+};
+
+// Matrix-free distances. Only the rows belonging to the current selection
+// (plus the background, if any) are stored; a row is recomputed from the
+// precomputed color coordinates whenever its slot is reassigned. Memory is
+// O(n_slots * n_colors) instead of O(n_colors^2). The coordinates are owned
+// by the CandidateDistances, which must outlive this.
+template<typename ColorType, typename Metric>
+class StripDistances
+{
+public:
+  StripDistances(
+    const std::vector<detail::DistanceRows<ColorType, Metric>>& rows,
+    std::size_t n_colors,
+    std::size_t n_slots)
+    : rows(rows)
+    , n_colors(n_colors)
+    , strip(n_slots * n_colors)
+  {
+  }
+
+  void assign(std::size_t slot, std::size_t i)
+  {
+    float* row = &strip[slot * n_colors];
+    const int n_blocks = static_cast<int>((n_colors + block - 1) / block);
+
+    // Pairs are evaluated in the same (lower, upper) order and precision as
+    // symmetricColorDifferenceMatrix() so both backends agree bit for bit.
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(Threads::get())
+#endif
+    for (int k = 0; k < n_blocks; ++k) {
+      const std::size_t begin = static_cast<std::size_t>(k) * block;
+      const std::size_t end = std::min(begin + block, n_colors);
+
+      std::array<double, block> d;
+      std::array<double, block> d_view;
+      rows.front()(i, begin, end, d.data());
+      for (std::size_t v = 1; v < rows.size(); ++v) {
+        rows[v](i, begin, end, d_view.data());
+        for (std::size_t j = 0; j < end - begin; ++j) {
+          d[j] = std::min(d[j], d_view[j]);
+        }
+      }
+      for (std::size_t j = 0; j < end - begin; ++j) {
+        row[begin + j] = static_cast<float>(d[j]);
+      }
+    }
+
+    row[i] = 0.0f;
+  }
+
+  double operator()(std::size_t slot, std::size_t j) const
+  {
+    return strip[slot * n_colors + j];
+  }
+
+private:
+  static constexpr std::size_t block = 256;
+
+  const std::vector<detail::DistanceRows<ColorType, Metric>>& rows;
+  std::size_t n_colors;
+  std::vector<float> strip;
+};
+
+// Converts the views to the color space of the metric.
+template<typename ColorType, typename Metric>
+std::vector<detail::DistanceRows<ColorType, Metric>>
+makeViewRows(const std::vector<std::vector<colors::XYZ>>& xyz_views,
+             const std::array<double, 3>& white_point)
+{
+  std::vector<detail::DistanceRows<ColorType, Metric>> rows;
+  rows.reserve(xyz_views.size());
+  for (const auto& xyz_view : xyz_views) {
+    rows.push_back(detail::makeDistanceRows(
+      colors::ColorBatch<ColorType>(xyz_view, white_point), Metric{}));
+  }
+  return rows;
+}
+
+template<typename ColorType, typename Metric>
+StripDistances<ColorType, Metric>
+makeStripDistances(
+  const std::vector<detail::DistanceRows<ColorType, Metric>>& rows,
+  std::size_t n_colors,
+  std::size_t n_slots,
+  const double max_memory)
+{
+  const double estimated_gb =
+    (n_slots * n_colors * sizeof(float) +
+     rows.size() * n_colors * sizeof(ColorType)) /
+    (1024.0 * 1024.0 * 1024.0);
+
+  if (estimated_gb > max_memory) {
+    throw std::runtime_error(
+      "Matrix-free distance storage would require " +
+      std::to_string(estimated_gb) + " GB, which exceeds the limit of " +
+      std::to_string(max_memory) +
+      " GB. Reduce the number of colors or increase the memory limit.");
+  }
+
+  return StripDistances<ColorType, Metric>(rows, n_colors, n_slots);
+}
+
+// For every color, the nearest and second-nearest selected slots. This gives
+// the distance from a color to the selection with any one slot left out in
+// O(1), and is updated in amortized O(n_colors) time after each swap.
+class NearestSelected
+{
+public:
+  template<typename Distances>
+  NearestSelected(const Distances& dist,
+                  const std::size_t n_slots,
+                  const std::size_t n_colors)
+    : n_slots(n_slots)
+    , nearest(n_colors)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(Threads::get())
+#endif
+    for (int x = 0; x < static_cast<int>(n_colors); ++x) {
+      rescan(dist, x);
+    }
+  }
+
+  struct Entry
+  {
+    std::size_t slot1, slot2;
+    double dist1, dist2;
+  };
+
+  // Minimum distance from color `x` to all selected slots except `slot`.
+  double excluding(const std::size_t x, const std::size_t slot) const
+  {
+    const Entry& e = nearest[x];
+    return e.slot1 == slot ? e.dist2 : e.dist1;
+  }
+
+  const Entry& operator[](const std::size_t x) const { return nearest[x]; }
+
+  // Colors whose entries were rebuilt by the last update(), in no particular
+  // order. The distances of all other colors can only have decreased.
+  const std::vector<std::size_t>& rescanned() const { return rescanned_list; }
+
+  // Refresh the bookkeeping after `slot` has been reassigned.
+  template<typename Distances>
+  void update(const Distances& dist, const std::size_t slot)
+  {
+    rescanned_list.clear();
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+    {
+      std::vector<std::size_t> local_rescanned;
+
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+      for (int x = 0; x < static_cast<int>(nearest.size()); ++x) {
+        Entry& e = nearest[x];
+        if (e.slot1 == slot || e.slot2 == slot) {
+          // The old distance may have been one of the two smallest, so the
+          // runner-up is unknown without a full scan.
+          rescan(dist, x);
+          local_rescanned.push_back(x);
+          continue;
+        }
+        const double d = dist(slot, x);
+        if (d < e.dist1) {
+          e.slot2 = e.slot1;
+          e.dist2 = e.dist1;
+          e.slot1 = slot;
+          e.dist1 = d;
+        } else if (d < e.dist2) {
+          e.slot2 = slot;
+          e.dist2 = d;
+        }
+      }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+      rescanned_list.insert(
+        rescanned_list.end(), local_rescanned.begin(), local_rescanned.end());
+    }
+  }
+
+private:
+  template<typename Distances>
+  void rescan(const Distances& dist, const std::size_t x)
+  {
+    constexpr double inf = std::numeric_limits<double>::max();
+    Entry e{ n_slots, n_slots, inf, inf };
+    for (std::size_t j = 0; j < n_slots; ++j) {
+      const double d = dist(j, x);
+      if (d < e.dist1) {
+        e.slot2 = e.slot1;
+        e.dist2 = e.dist1;
+        e.slot1 = j;
+        e.dist1 = d;
+      } else if (d < e.dist2) {
+        e.slot2 = j;
+        e.dist2 = d;
+      }
+    }
+    nearest[x] = e;
+  }
+
+  std::size_t n_slots;
+  std::vector<Entry> nearest;
+  std::vector<std::size_t> rescanned_list;
+};
+
+// Upper bounds, for every cell of a LabGrid, on the distance from the
+// unselected colors in the cell to the selection with any one slot left out.
+// Colors that lie close together have similar distances to the selection, so
+// the bounds are tight, and a cell whose bound does not exceed the distance
+// to beat can be skipped without looking at its colors.
+class CellBounds
+{
+public:
+  explicit CellBounds(const LabGrid& grid)
+    : grid(grid)
+    , cells(grid.cellCount())
+  {
+  }
+
+  // Recompute the bounds from `nearest` for the colors `x` with
+  // `position[x] != npos`.
+  void reset(const NearestSelected& nearest,
+             const std::vector<std::size_t>& position)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(Threads::get())
+#endif
+    for (int c = 0; c < static_cast<int>(cells.size()); ++c) {
+      constexpr double lowest = std::numeric_limits<double>::lowest();
+      Cell cell{ lowest, lowest, none };
+      for (std::size_t x : grid.cell(c)) {
+        if (position[x] == npos) {
+          continue;
+        }
+        cell.include(nearest[x]);
+      }
+      cells[c] = cell;
+    }
+  }
+
+  // Loosen the bounds to cover color `x`. Since NearestSelected::update()
+  // only ever lowers the distances of the colors that it does not rescan,
+  // the bounds stay valid after a swap if they are loosened to cover the
+  // rescanned colors and the color that joined the complement.
+  void include(const NearestSelected& nearest, const std::size_t x)
+  {
+    cells[grid.cellOf(x)].include(nearest[x]);
+  }
+
+  // Bound on NearestSelected::excluding(x, slot) for the colors in cell `c`.
+  // Only colors nearest to `slot` can be farther than their nearest slot.
+  double bound(const std::size_t c, const std::size_t slot) const
+  {
+    const Cell& cell = cells[c];
+    return cell.owner == slot || cell.owner == mixed
+             ? std::max(cell.dist1, cell.dist2)
+             : cell.dist1;
+  }
+
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+private:
+  static constexpr std::size_t none = npos;
+  static constexpr std::size_t mixed = npos - 1;
+
+  struct Cell
+  {
+    double dist1, dist2;
+    // The nearest slot shared by all colors in the cell, or none or mixed.
+    std::size_t owner;
+
+    void include(const NearestSelected::Entry& e)
+    {
+      dist1 = std::max(dist1, e.dist1);
+      dist2 = std::max(dist2, e.dist2);
+      if (owner == none) {
+        owner = e.slot1;
+      } else if (owner != e.slot1) {
+        owner = mixed;
+      }
+    }
+  };
+
+  const LabGrid& grid;
+  std::vector<Cell> cells;
+};
+
+// A replacement candidate: its position in the complement set and its
+// minimum distance to the rest of the selection.
+struct Candidate
+{
+  double dist;
+  std::size_t k;
+};
+
+// Exchange loop shared by all distance backends. Slots [0, n) hold the
+// selection; slot n holds the background when `has_bg` is set. Without
+// `exchange`, the farthest-first traversal is returned as it is.
+template<typename Distances>
+std::vector<std::size_t>
+swapSelect(Distances& dist,
+           const LabGrid& grid,
+           const std::size_t n,
+           const std::size_t n_colors,
+           const bool has_bg,
+           const std::size_t n_fixed,
+           const std::vector<std::size_t>& initial,
+           const bool exchange)
+{
+  if (has_bg) {
+    dist.assign(n, n_colors - 1);
+  }
+
+  // Begin with the fixed points, or the initial selection, and fill up to n
+  // by adding, one at a time, the color farthest from the colors selected so
+  // far and from the background. This farthest-first traversal is within a
+  // factor of two of the optimal minimum distance, so the exchange loop
+  // starts close to a local optimum and needs few passes.
+  std::vector<std::size_t> r = initial;
+  if (r.empty()) {
+    r.resize(n_fixed);
+    std::iota(r.begin(), r.end(), 0);
+  }
+
+  const std::size_t n_last = n_colors - (has_bg ? 1 : 0);
+  std::vector<char> in_r(n_colors, 0);
+  for (std::size_t j = 0; j < r.size(); ++j) {
+    dist.assign(j, r[j]);
+    in_r[r[j]] = 1;
+  }
+
+  // Distance from every candidate to the colors selected so far
+  std::vector<double> min_dist_r(n_colors);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(Threads::get())
+#endif
+  for (int x = static_cast<int>(n_fixed); x < static_cast<int>(n_last); ++x) {
+    double d = has_bg ? dist(n, x) : std::numeric_limits<double>::max();
+    for (std::size_t j = 0; j < r.size(); ++j) {
+      d = std::min(d, dist(j, x));
+    }
+    min_dist_r[x] = d;
+  }
+
+  while (r.size() < n) {
+    // The farthest candidate, with ties going to the lowest index
+    const Candidate none{ -1.0, n_colors };
+    Candidate best = none;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+    {
+      Candidate local = none;
+
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+      for (int x = static_cast<int>(n_fixed); x < static_cast<int>(n_last);
+           ++x) {
+        if (!in_r[x] && min_dist_r[x] > local.dist) {
+          local = { min_dist_r[x], static_cast<std::size_t>(x) };
+        }
+      }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+      if (local.dist > best.dist ||
+          (local.dist == best.dist && local.k < best.k)) {
+        best = local;
+      }
+    }
+
+    const std::size_t slot = r.size();
+    r.push_back(best.k);
+    dist.assign(slot, best.k);
+    in_r[best.k] = 1;
+
+    if (r.size() < n) {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(Threads::get())
+#endif
+      for (int x = static_cast<int>(n_fixed); x < static_cast<int>(n_last);
+           ++x) {
+        min_dist_r[x] = std::min(min_dist_r[x], dist(slot, x));
+      }
+    }
+  }
+
+  if (!exchange) {
+    return r;
+  }
+
+  // Store the complement to r (excluding fixed points).
+  std::vector<std::size_t> r_c;
+  r_c.reserve(n_last - n_fixed - (n - n_fixed));
+  for (std::size_t x = n_fixed; x < n_last; ++x) {
+    if (!in_r[x]) {
+      r_c.push_back(x);
+    }
+  }
+
+  NearestSelected nearest(dist, n, n_colors);
+
+  // Position of every color in r_c, or npos for the other colors.
+  constexpr std::size_t npos = CellBounds::npos;
+  std::vector<std::size_t> position(n_colors, npos);
+  for (std::size_t k = 0; k < r_c.size(); ++k) {
+    position[r_c[k]] = k;
+  }
+
+  CellBounds bounds(grid);
+
+  bool set_changed = true;
+
+  while (set_changed) {
+    set_changed = false;
+
+    // The bounds are loosened after every swap; tighten them once per pass.
+    bounds.reset(nearest, position);
+
+    for (std::size_t i = n_fixed; i < n; ++i) {
+      // Find the distance between the current point and the others in the
+      // currently selected set (r).
+      double min_dist_old = nearest.excluding(r[i], i);
+
+      if (has_bg) {
+        min_dist_old = std::min(min_dist_old, dist(n, r[i]));
+      }
+
+      // Check if any point in the complement set (r_c) has a greater minimum
+      // distance to the points currently selected (r). The search goes cell
+      // by cell, skipping the cells that cannot hold such a point. Each
+      // thread keeps the strict maximum with the lowest position in r_c and
+      // so does the merge, which matches a serial scan of r_c exactly.
+      const Candidate none{ min_dist_old, r_c.size() };
+      Candidate best = none;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(Threads::get())
+#endif
+      {
+        Candidate local = none;
+
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+        for (int c = 0; c < static_cast<int>(grid.cellCount()); ++c) {
+          const double bound = bounds.bound(c, i);
+          if (bound <= min_dist_old || bound < local.dist) {
+            continue;
+          }
+
+          for (std::size_t x : grid.cell(c)) {
+            const std::size_t k = position[x];
+            if (k == npos) {
+              continue;
+            }
+
+            double min_dist_k = nearest.excluding(x, i);
+
+            if (has_bg) {
+              min_dist_k = std::min(min_dist_k, dist(n, x));
+            }
+
+            if (min_dist_k > min_dist_old &&
+                (min_dist_k > local.dist ||
+                 (min_dist_k == local.dist && k < local.k))) {
+              local = { min_dist_k, k };
+            }
+          }
+        }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        if (local.dist > best.dist ||
+            (local.dist == best.dist && local.k < best.k)) {
+          best = local;
+        }
+      }
+
+      // If we have found a better point in r_c, swap places with the current
+      // point.
+      if (best.k < r_c.size()) {
+        std::swap(r[i], r_c[best.k]);
+        position[r_c[best.k]] = best.k;
+        position[r[i]] = npos;
+        dist.assign(i, r[i]);
+        nearest.update(dist, i);
+        for (std::size_t x : nearest.rescanned()) {
+          if (position[x] != npos) {
+            bounds.include(nearest, x);
+          }
+        }
+        bounds.include(nearest, r_c[best.k]);
+        set_changed = true;
+      }
+    }
+  }
+
+  for (std::size_t i = n_fixed; i < n; ++i) {
+    assert(r[i] >= n_fixed &&
+           "Non-candidate index found in candidate selection!");
+  }
+
+  // Arrange the colors in the palette according to how distinct they are from
+  // one another.
+  std::vector<double> min_dist(n, std::numeric_limits<double>::max());
+  for (std::size_t i = n_fixed; i < n; ++i) {
+    for (std::size_t j = n_fixed; j < n; ++j) {
+      if (j != i) {
+        min_dist[i] = std::min(min_dist[i], dist(j, r[i]));
+      }
+    }
+  }
+
+  std::vector<std::size_t> order(n - n_fixed);
+  std::iota(order.begin(), order.end(), n_fixed);
+  std::stable_sort(
+    order.begin(), order.end(), [&min_dist](std::size_t a, std::size_t b) {
+      return min_dist[a] > min_dist[b];
+    });
+
+  std::vector<std::size_t> result(r.begin(), r.begin() + n_fixed);
+  for (std::size_t i : order) {
+    result.push_back(r[i]);
+  }
+
+  return result;
+}
+
+template<typename ColorType, typename Metric>
+std::vector<std::size_t>
+matrixFreeSelect(const CandidateDistances& distances,
+                 const std::size_t n,
+                 const bool has_bg,
+                 const std::size_t n_fixed,
+                 const std::vector<std::size_t>& initial,
+                 const bool exchange)
+{
+  const std::size_t n_colors = distances.size();
+  auto dist = makeStripDistances(distances.rows<ColorType, Metric>(),
+                                 n_colors,
+                                 n + (has_bg ? 1 : 0),
+                                 distances.maxMemory());
+  return swapSelect(
+    dist, distances.grid(), n, n_colors, has_bg, n_fixed, initial, exchange);
+}
+
+std::vector<std::size_t>
+select(const CandidateDistances& distances,
+       const std::size_t n,
+       const bool has_bg,
+       const std::size_t n_fixed,
+       const std::vector<std::size_t>& initial,
+       const bool exchange)
+{
+  const std::size_t n_colors = distances.size();
+  const std::size_t n_slots = n + (has_bg ? 1 : 0);
+
+  if (const auto* dist_mat = distances.matrix()) {
+    DenseDistances dist(*dist_mat, n_slots);
+    return swapSelect(
+      dist, distances.grid(), n, n_colors, has_bg, n_fixed, initial, exchange);
+  }
+
+  switch (distances.metricType()) {
+    case metrics::MetricType::DIN99d:
+      return matrixFreeSelect<colors::DIN99d, metrics::DIN99d>(
+        distances, n, has_bg, n_fixed, initial, exchange);
+    case metrics::MetricType::CIEDE2000:
+      return matrixFreeSelect<colors::Lab, metrics::CIEDE2000>(
+        distances, n, has_bg, n_fixed, initial, exchange);
+    case metrics::MetricType::CIE76:
+      return matrixFreeSelect<colors::Lab, metrics::CIE76>(
+        distances, n, has_bg, n_fixed, initial, exchange);
+  }
+  throw std::invalid_argument("Unsupported metric type");
+}
+
+} // namespace
+
+CandidateDistances::CandidateDistances(
+  const std::vector<colors::XYZ>& colors,
+  const metrics::MetricType& metric_type,
+  const double max_memory,
+  const std::array<double, 3>& white_point,
+  const std::map<std::string, double>& cvd)
+  : n_colors(colors.size())
+  , metric_type(metric_type)
+  , max_memory(max_memory)
+  , white_point(white_point)
+{
+  const colors::LabBatch labs(colors, white_point);
+  lab_grid = LabGrid(labs.l(), labs.a(), labs.b(), n_colors);
+
+  auto views = cvdViews(colors, cvd);
+
+  // Fall back to computing distances on demand when the packed matrix does
+  // not fit within the memory limit.
+  if (!detail::checkSymmetricMatrixSize<float>(n_colors, max_memory)) {
+    switch (metric_type) {
+      case metrics::MetricType::DIN99d:
+        view_rows =
+          makeViewRows<colors::DIN99d, metrics::DIN99d>(views, white_point);
+        return;
+      case metrics::MetricType::CIEDE2000:
+        view_rows =
+          makeViewRows<colors::Lab, metrics::CIEDE2000>(views, white_point);
+        return;
+      case metrics::MetricType::CIE76:
+        view_rows =
+          makeViewRows<colors::Lab, metrics::CIE76>(views, white_point);
+        return;
+    }
+    throw std::invalid_argument("Unsupported metric type");
+  }
+
+  // Minimum distance over normal vision and every CVD view, in one matrix
+  dist_mat =
+    minColorDifferenceMatrix(views, metric_type, max_memory, white_point);
+}
+
+std::vector<std::size_t>
+farthestPoints(const std::size_t n,
+               const CandidateDistances& distances,
+               const bool has_bg,
+               const std::size_t n_fixed,
+               const std::vector<std::size_t>& initial)
+{
+  const std::size_t n_colors = distances.size();
+  const std::size_t n_candidates = n_colors - n_fixed - (has_bg ? 1 : 0);
+
+  if (n - n_fixed > n_candidates) {
+    throw std::invalid_argument(
+      "Requested number of new colors exceeds candidate pool.");
+  }
+  if (!initial.empty() && (initial.size() < n_fixed || initial.size() > n)) {
+    throw std::invalid_argument(
+      "Initial selection must contain the fixed colors and at most n colors.");
+  }
+
+  return select(distances, n, has_bg, n_fixed, initial, true);
+}
+
+std::vector<std::size_t>
+farthestFirst(const std::size_t n,
+              const CandidateDistances& distances,
+              const bool has_bg)
+{
+  const std::size_t n_candidates = distances.size() - (has_bg ? 1 : 0);
+
+  if (n > n_candidates) {
+    throw std::invalid_argument(
+      "Requested number of new colors exceeds candidate pool.");
+  }
+
+  return select(distances, n, has_bg, 0, {}, false);
+}
+
+std::vector<std::size_t>
+farthestPoints(const std::size_t n,
+               const std::vector<colors::XYZ>& colors,
+               const metrics::MetricType& metric_type,
+               const bool has_bg,
+               const std::size_t n_fixed,
+               const double max_memory,
+               const std::array<double, 3>& white_point,
+               const std::map<std::string, double>& cvd)
+{
+  const std::size_t n_candidates = colors.size() - n_fixed - (has_bg ? 1 : 0);
+  if (n - n_fixed > n_candidates) {
+    throw std::invalid_argument(
+      "Requested number of new colors exceeds candidate pool.");
+  }
+
+  const CandidateDistances distances(
+    colors, metric_type, max_memory, white_point, cvd);
+  return farthestPoints(n, distances, has_bg, n_fixed);
+}
+
+} // namespace qualpal
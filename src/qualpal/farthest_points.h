@@ -1,25 +1,108 @@
-#pragma once
-
-#include <cmath>
-#include <map>
-#include <qualpal/color_difference.h>
-#include <qualpal/colors.h>
-#include <qualpal/matrix.h>
-#include <string>
-#include <vector>
-
-namespace qualpal {
-
-std::vector<std::size_t>
-farthestPoints(const std::size_t n,
-               const std::vector<colors::XYZ>& colors,
-               const metrics::MetricType& metric_type,
-               const bool has_bg = false,
-               const std::size_t n_fixed = 0,
-               const double max_memory = 1,
-               const std::array<double, 3>& white_point = { 0.95047,
-                                                            1,
-                                                            1.08883 },
-               const std::map<std::string, double>& cvd = {});
-
-} // namespace qualpal
+#pragma once
+
+#include "spatial_index.h"
+#include <array>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <qualpal/color_difference.h>
+#include <qualpal/colors.h>
+#include <qualpal/matrix.h>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace qualpal {
+
+// The distances that farthestPoints() selects from. They depend on the colors
+// and the settings but not on the number of colors to select, so they can be
+// built once and reused for any `n`. This holds the packed matrix of minimum
+// distances over normal vision and every CVD view or, when that matrix does
+// not fit within `max_memory`, the views themselves, converted once to the
+// color space of the metric, from which distances are computed on demand. It
+// also holds a grid over the Lab coordinates of
+// the colors, which lets the exchange loop skip whole regions of colors.
+class CandidateDistances
+{
+public:
+  CandidateDistances(const std::vector<colors::XYZ>& colors,
+                     const metrics::MetricType& metric_type,
+                     const double max_memory = 1,
+                     const std::array<double, 3>& white_point = { 0.95047,
+                                                                  1,
+                                                                  1.08883 },
+                     const std::map<std::string, double>& cvd = {});
+
+  std::size_t size() const { return n_colors; }
+  metrics::MetricType metricType() const { return metric_type; }
+  double maxMemory() const { return max_memory; }
+  const std::array<double, 3>& whitePoint() const { return white_point; }
+
+  // The packed matrix, or nullptr in matrix-free mode.
+  const SymmetricMatrix<float>* matrix() const
+  {
+    return dist_mat ? &*dist_mat : nullptr;
+  }
+
+  // The colors under normal vision and each CVD view, as distance rows in
+  // the color space of the metric; only set in matrix-free mode, and only
+  // for the ColorType and Metric that match metricType().
+  template<typename ColorType, typename Metric>
+  const std::vector<detail::DistanceRows<ColorType, Metric>>& rows() const
+  {
+    return std::get<std::vector<detail::DistanceRows<ColorType, Metric>>>(
+      view_rows);
+  }
+
+  // Grid over the colors under normal vision, in Lab.
+  const LabGrid& grid() const { return lab_grid; }
+
+private:
+  std::size_t n_colors;
+  metrics::MetricType metric_type;
+  double max_memory;
+  std::array<double, 3> white_point;
+  std::optional<SymmetricMatrix<float>> dist_mat;
+  std::variant<
+    std::monostate,
+    std::vector<detail::DistanceRows<colors::Lab, metrics::CIEDE2000>>,
+    std::vector<detail::DistanceRows<colors::DIN99d, metrics::DIN99d>>,
+    std::vector<detail::DistanceRows<colors::Lab, metrics::CIE76>>>
+    view_rows;
+  LabGrid lab_grid;
+};
+
+// Selects `n` colors from `distances`. The selection starts from `initial`,
+// or from the fixed colors when it is empty, is grown to `n` colors by
+// repeatedly adding the color farthest from it and the background, and is
+// then improved by the usual exchanges. `initial` must begin with the
+// `n_fixed` fixed colors.
+std::vector<std::size_t>
+farthestPoints(const std::size_t n,
+               const CandidateDistances& distances,
+               const bool has_bg = false,
+               const std::size_t n_fixed = 0,
+               const std::vector<std::size_t>& initial = {});
+
+// The first `n` colors of the farthest-first traversal of `distances`: each
+// color is the one farthest from the colors before it and the background,
+// with ties going to the lowest index. Every prefix is the traversal for
+// fewer colors, and no exchanges are made.
+std::vector<std::size_t>
+farthestFirst(const std::size_t n,
+              const CandidateDistances& distances,
+              const bool has_bg = false);
+
+std::vector<std::size_t>
+farthestPoints(const std::size_t n,
+               const std::vector<colors::XYZ>& colors,
+               const metrics::MetricType& metric_type,
+               const bool has_bg = false,
+               const std::size_t n_fixed = 0,
+               const double max_memory = 1,
+               const std::array<double, 3>& white_point = { 0.95047,
+                                                            1,
+                                                            1.08883 },
+               const std::map<std::string, double>& cvd = {});
+
+} // namespace qualpal
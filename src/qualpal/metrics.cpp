@@ -0,0 +1,330 @@
+#include "simd.h"
+#include <cmath>
+#include <qualpal/metrics.h>
+
+namespace qualpal {
+namespace metrics {
+
+namespace {
+
+// The kernel below avoids libm calls and data-dependent branches so that the
+// loop over colors vectorizes. It uses only correctly rounded operations
+// (this file is built without floating-point contraction), so every
+// instruction set produces the same bits.
+
+constexpr double pi = 3.14159265358979323846;
+
+// Taylor polynomials, accurate to double precision for |x| <= pi/4.
+QUALPAL_ALWAYS_INLINE double
+sinPoly(double x)
+{
+  const double z = x * x;
+  double p = -1.0 / 1307674368000;
+  p = p * z + 1.0 / 6227020800;
+  p = p * z - 1.0 / 39916800;
+  p = p * z + 1.0 / 362880;
+  p = p * z - 1.0 / 5040;
+  p = p * z + 1.0 / 120;
+  p = p * z - 1.0 / 6;
+  p = p * z + 1.0;
+  return p * x;
+}
+
+QUALPAL_ALWAYS_INLINE double
+cosPoly(double x)
+{
+  const double z = x * x;
+  double p = 1.0 / 20922789888000;
+  p = p * z - 1.0 / 87178291200;
+  p = p * z + 1.0 / 479001600;
+  p = p * z - 1.0 / 3628800;
+  p = p * z + 1.0 / 40320;
+  p = p * z - 1.0 / 720;
+  p = p * z + 1.0 / 24;
+  p = p * z - 1.0 / 2;
+  p = p * z + 1.0;
+  return p;
+}
+
+// Sine and cosine of an angle in degrees. The angle is reduced exactly to
+// [-45, 45] degrees around the nearest multiple of 90, and the quadrant then
+// picks and negates the polynomial results. sind(-x) == -sind(x) exactly.
+QUALPAL_ALWAYS_INLINE void
+sincosd(double degrees, double& s, double& c)
+{
+  const double r = degrees - 360.0 * std::nearbyint(degrees / 360.0);
+  const double q = std::nearbyint(r / 90.0);
+  const double x = (r - 90.0 * q) * (pi / 180.0);
+  const double sp = sinPoly(x);
+  const double cp = cosPoly(x);
+
+  s = q == 0 ? sp : (q == 1 ? cp : (q == -1 ? -cp : -sp));
+  c = q == 0 ? cp : (q == 1 ? -sp : (q == -1 ? sp : -cp));
+}
+
+// Arc tangent of t in [0, 1], using the Cephes rational approximation.
+QUALPAL_ALWAYS_INLINE double
+atanUnit(double t)
+{
+  const bool upper = t > 0.66;
+  const double shifted = (t - 1.0) / (t + 1.0);
+  const double x = upper ? shifted : t;
+  const double z = x * x;
+  double p = -8.750608600031904122785e-1;
+  p = p * z - 1.615753718733365076637e1;
+  p = p * z - 7.500855792314704667340e1;
+  p = p * z - 1.228866684490136173410e2;
+  p = p * z - 6.485021904942025371773e1;
+  double q = z + 2.485846490142306297962e1;
+  q = q * z + 1.650270098316988542046e2;
+  q = q * z + 4.328810604912902668951e2;
+  q = q * z + 4.853903996359136964868e2;
+  q = q * z + 1.945506571482613964425e2;
+  const double r = x * (z * p / q) + x;
+
+  return r + (upper ? pi / 4 + 0.5 * 6.123233995736765886130e-17 : 0.0);
+}
+
+// Same convention as detail::atan2d(): degrees in [0, 360).
+QUALPAL_ALWAYS_INLINE double
+atan2d(double y, double x)
+{
+  const double ax = std::abs(x);
+  const double ay = std::abs(y);
+  const double hi = ax > ay ? ax : ay;
+  const double lo = ax > ay ? ay : ax;
+
+  // The tiny offset keeps the division defined for achromatic colors.
+  double r = atanUnit(lo / (hi + 1e-300));
+  const double r_steep = pi / 2 - r;
+  r = ay > ax ? r_steep : r;
+  const double r_left = pi - r;
+  r = std::copysign(1.0, x) < 0 ? r_left : r;
+  r = std::copysign(r, y);
+
+  const double deg = r * 180.0 / pi;
+  return deg + (deg >= 0 ? 0.0 : 360.0);
+}
+
+// exp(x) for x in [-128, 0], as the 256th power of exp(x / 256).
+QUALPAL_ALWAYS_INLINE double
+expNegative(double x)
+{
+  const double y = x / 256.0;
+  double e = 1.0 / 6227020800;
+  e = e * y + 1.0 / 479001600;
+  e = e * y + 1.0 / 39916800;
+  e = e * y + 1.0 / 3628800;
+  e = e * y + 1.0 / 362880;
+  e = e * y + 1.0 / 40320;
+  e = e * y + 1.0 / 5040;
+  e = e * y + 1.0 / 720;
+  e = e * y + 1.0 / 120;
+  e = e * y + 1.0 / 24;
+  e = e * y + 1.0 / 6;
+  e = e * y + 1.0 / 2;
+  e = e * y + 1.0;
+  e = e * y + 1.0;
+  e *= e;
+  e *= e;
+  e *= e;
+  e *= e;
+  e *= e;
+  e *= e;
+  e *= e;
+  e *= e;
+  return e;
+}
+
+QUALPAL_ALWAYS_INLINE double
+pow7(double x)
+{
+  const double x2 = x * x;
+  return x2 * x2 * x2 * x;
+}
+
+// Mirrors CIEDE2000::operator() step by step, with the trigonometry of the
+// mean hue expanded from a single sine/cosine pair. The pair computation is
+// written out in the loop body so that it is inlined and vectorized.
+QUALPAL_TARGET_CLONES void
+ciede2000Batch(double l1,
+               double a1,
+               double b1,
+               const double* l,
+               const double* a,
+               const double* b,
+               std::size_t n,
+               double K_L,
+               double K_C,
+               double K_H,
+               double* out)
+{
+  constexpr double pow25_7 = 6103515625.0;
+  constexpr double cos6 = 0.99452189536827333692;
+  constexpr double sin6 = 0.10452846326765347140;
+  constexpr double cos30 = 0.86602540378443864676;
+  constexpr double cos63 = 0.45399049973954679156;
+  constexpr double sin63 = 0.89100652418836786236;
+
+  const double C1 = std::sqrt(a1 * a1 + b1 * b1);
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t k = 0; k < n; ++k) {
+    const double l2 = l[k];
+    const double a2 = a[k];
+    const double b2 = b[k];
+
+    const double L_hat_prime = (l1 + l2) / 2.0;
+    const double C2 = std::sqrt(a2 * a2 + b2 * b2);
+    const double C_hat_7 = pow7((C1 + C2) / 2.0);
+    const double G = 0.5 * (1 - std::sqrt(C_hat_7 / (C_hat_7 + pow25_7)));
+    const double a1_prime = a1 * (1.0 + G);
+    const double a2_prime = a2 * (1.0 + G);
+    const double C1_prime = std::sqrt(a1_prime * a1_prime + b1 * b1);
+    const double C2_prime = std::sqrt(a2_prime * a2_prime + b2 * b2);
+    const double C_hat_prime = (C1_prime + C2_prime) / 2.0;
+
+    const double h1_prime = atan2d(b1, a1_prime);
+    const double h2_prime = atan2d(b2, a2_prime);
+
+    const double H_hat_prime =
+      (h1_prime + h2_prime +
+       (std::abs(h1_prime - h2_prime) > 180 ? 360.0 : 0.0)) /
+      2.0;
+
+    double s1, c1;
+    sincosd(H_hat_prime, s1, c1);
+    const double c2 = 2 * c1 * c1 - 1;
+    const double s2 = 2 * s1 * c1;
+    const double c3 = c2 * c1 - s2 * s1;
+    const double s3 = s2 * c1 + c2 * s1;
+    const double c4 = 2 * c2 * c2 - 1;
+    const double s4 = 2 * s2 * c2;
+
+    const double T = 1.0 - 0.17 * (c1 * cos30 + s1 * 0.5) + 0.24 * c2 +
+                     0.32 * (c3 * cos6 - s3 * sin6) -
+                     0.20 * (c4 * cos63 + s4 * sin63);
+
+    double delta_h_prime = h2_prime - h1_prime;
+    delta_h_prime += std::abs(delta_h_prime) > 180
+                       ? (h2_prime <= h1_prime ? 360.0 : -360.0)
+                       : 0.0;
+
+    const double delta_L_prime = l2 - l1;
+    const double delta_C_prime = C2_prime - C1_prime;
+
+    double sin_half_h, cos_half_h;
+    sincosd(delta_h_prime / 2.0, sin_half_h, cos_half_h);
+    const double delta_H_prime =
+      2 * std::sqrt(C1_prime * C2_prime) * sin_half_h;
+
+    const double L_dev = (L_hat_prime - 50) * (L_hat_prime - 50);
+    const double S_L = 1 + (0.015 * L_dev) / std::sqrt(20 + L_dev);
+    const double S_C = 1 + 0.045 * C_hat_prime;
+    const double S_H = 1 + 0.015 * C_hat_prime * T;
+
+    // H_hat_prime is in [0, 540), so the exponent is in [-121, 0].
+    const double u = (H_hat_prime - 275) / 25;
+    const double delta_theta = 30 * expNegative(-(u * u));
+
+    const double C_hat_prime_7 = pow7(C_hat_prime);
+    const double R_C = 2 * std::sqrt(C_hat_prime_7 / (C_hat_prime_7 + pow25_7));
+
+    double sin_2theta, cos_2theta;
+    sincosd(2 * delta_theta, sin_2theta, cos_2theta);
+    const double R_T = -R_C * sin_2theta;
+
+    const double t_L = delta_L_prime / (K_L * S_L);
+    const double t_C = delta_C_prime / (K_C * S_C);
+    const double t_H = delta_H_prime / (K_H * S_H);
+
+    out[k] = std::sqrt(t_L * t_L + t_C * t_C + t_H * t_H + R_T * t_C * t_H);
+  }
+}
+
+// Lower bound on ciede2000Batch(). Writing t_L, t_C, and t_H for the three
+// weighted terms, the difference is the square root of
+// t_L^2 + t_C^2 + t_H^2 + R_T t_C t_H, and:
+//
+// - |R_T| <= 2 sin(60 deg), so the last term takes away at most
+//   sin(60 deg) (t_C^2 + t_H^2).
+// - S_L <= 1 + 0.015 |L_hat - 50|.
+// - T < 1.58, so S_H < 1 + 0.0237 C_hat', and the chroma and hue terms
+//   together are at least (delta C'^2 + delta H'^2) / S^2 with
+//   S = max(K_C S_C, K_H S_H). The numerator is the squared distance in the
+//   a'b' plane, which is at least the one in the ab plane since a' is a
+//   scaled up by 1 + G, with G in [0, 0.5]. For the same reason
+//   C_hat' <= 1.5 C_hat.
+//
+// The result is scaled down slightly to absorb rounding.
+QUALPAL_TARGET_CLONES void
+ciede2000LowerBound(double l1,
+                    double a1,
+                    double b1,
+                    const double* l,
+                    const double* a,
+                    const double* b,
+                    std::size_t n,
+                    double K_L,
+                    double K_C,
+                    double K_H,
+                    double* out)
+{
+  constexpr double rotation = 1.0 - 0.86602540378443864676;
+  constexpr double margin = 1.0 - 1e-9;
+
+  const double C1 = std::sqrt(a1 * a1 + b1 * b1);
+
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (std::size_t k = 0; k < n; ++k) {
+    const double delta_L = l[k] - l1;
+    const double delta_a = a[k] - a1;
+    const double delta_b = b[k] - b1;
+
+    const double L_hat = (l1 + l[k]) / 2.0;
+    const double L_dist = L_hat < 50 ? 50 - L_hat : L_hat - 50;
+    const double S_L = 1 + 0.015 * L_dist;
+
+    const double C2 = std::sqrt(a[k] * a[k] + b[k] * b[k]);
+    const double C_hat_prime = 1.5 * (C1 + C2) / 2.0;
+    const double S_C = K_C * (1 + 0.045 * C_hat_prime);
+    const double S_H = K_H * (1 + 0.0237 * C_hat_prime);
+    const double S = S_C > S_H ? S_C : S_H;
+
+    const double t_L = delta_L / (K_L * S_L);
+    const double t_CH = (delta_a * delta_a + delta_b * delta_b) / (S * S);
+
+    out[k] = margin * std::sqrt(t_L * t_L + rotation * t_CH);
+  }
+}
+
+} // namespace
+
+void
+CIEDE2000::batch(const colors::Lab& x,
+                 const double* l,
+                 const double* a,
+                 const double* b,
+                 std::size_t n,
+                 double* out) const
+{
+  ciede2000Batch(x.l(), x.a(), x.b(), l, a, b, n, K_L, K_C, K_H, out);
+}
+
+void
+CIEDE2000::lowerBound(const colors::Lab& x,
+                      const double* l,
+                      const double* a,
+                      const double* b,
+                      std::size_t n,
+                      double* out) const
+{
+  ciede2000LowerBound(x.l(), x.a(), x.b(), l, a, b, n, K_L, K_C, K_H, out);
+}
+
+} // namespace metrics
+} // namespace qualpal
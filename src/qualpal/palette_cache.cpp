@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <qualpal/palette_cache.h>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <process.h>
+#define GETPID _getpid
+#else
+#include <unistd.h>
+#define GETPID getpid
+#endif
+
+namespace qualpal {
+
+namespace {
+
+// SplitMix64 finalizer, a bijection that spreads every input bit over the
+// whole word.
+std::uint64_t
+mix(std::uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x;
+}
+
+std::uint64_t
+rotl(std::uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+// First line of a cache file: the digest and the fingerprint of its key.
+std::string
+fileHeader(const PaletteKey& key)
+{
+  std::ostringstream header;
+  header << key.digest() << ' ' << std::hex << std::setw(8)
+         << std::setfill('0') << key.fingerprint;
+  return header.str();
+}
+
+// Numbers the temporary files written by this process.
+std::atomic<std::uint64_t> tmp_counter{ 0 };
+
+} // namespace
+
+std::string
+PaletteKey::digest() const
+{
+  std::ostringstream digest;
+  digest << std::hex << std::setfill('0') << std::setw(16) << high
+         << std::setw(16) << low;
+  return digest.str();
+}
+
+// Each value goes into three hashes with different constants: two make up
+// the digest and the third gives the fingerprint.
+PaletteKeyBuilder&
+PaletteKeyBuilder::addInteger(std::uint64_t value)
+{
+  first = rotl(first ^ mix(value), 23) * 0x9e3779b97f4a7c15;
+  second = rotl(second ^ mix(value ^ 0x6a09e667f3bcc909), 31) *
+           0xc2b2ae3d27d4eb4f;
+  third = rotl(third ^ mix(value + 0xbb67ae8584caa73b), 17) *
+          0x165667b19e3779f9;
+  ++count;
+  return *this;
+}
+
+PaletteKeyBuilder&
+PaletteKeyBuilder::addNumber(double value)
+{
+  std::uint64_t bits;
+  static_assert(sizeof(bits) == sizeof(value), "double must be 64 bits");
+  std::memcpy(&bits, &value, sizeof(bits));
+  return addInteger(bits);
+}
+
+PaletteKeyBuilder&
+PaletteKeyBuilder::addString(const std::string& value)
+{
+  addInteger(value.size());
+  // Bytes are packed little-endian into words, whatever the platform.
+  for (std::size_t i = 0; i < value.size(); i += 8) {
+    std::uint64_t word = 0;
+    for (std::size_t k = i; k < std::min(i + 8, value.size()); ++k) {
+      word |= static_cast<std::uint64_t>(static_cast<unsigned char>(value[k]))
+              << (8 * (k - i));
+    }
+    addInteger(word);
+  }
+  return *this;
+}
+
+PaletteKey
+PaletteKeyBuilder::key() const
+{
+  PaletteKey key;
+  key.high = mix(first ^ count);
+  key.low = mix(second + count);
+  key.fingerprint = static_cast<std::uint32_t>(mix(third ^ count) >> 32);
+  return key;
+}
+
+PaletteCache::PaletteCache(std::size_t max_entries, std::string directory)
+  : max_entries(max_entries)
+  , directory(std::move(directory))
+{
+  if (max_entries == 0) {
+    throw std::invalid_argument("Cache size must be positive");
+  }
+  if (!this->directory.empty()) {
+    std::error_code ec;
+    std::filesystem::create_directories(this->directory, ec);
+  }
+}
+
+std::optional<std::vector<colors::RGB>>
+PaletteCache::find(const PaletteKey& key)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find({ key.high, key.low });
+    if (it != index.end() &&
+        it->second->first.fingerprint == key.fingerprint) {
+      entries.splice(entries.begin(), entries, it->second);
+      ++hit_count;
+      return it->second->second;
+    }
+    if (directory.empty()) {
+      ++miss_count;
+      return std::nullopt;
+    }
+  }
+
+  // The file is read without the lock, so that other lookups are not held
+  // up by the disk.
+  auto palette = readFile(key);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!palette) {
+    ++miss_count;
+    return std::nullopt;
+  }
+  insertInMemory(key, *palette);
+  ++hit_count;
+  return palette;
+}
+
+void
+PaletteCache::insert(const PaletteKey& key,
+                     const std::vector<colors::RGB>& palette)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    insertInMemory(key, palette);
+  }
+  if (!directory.empty()) {
+    writeFile(key, palette);
+  }
+}
+
+void
+PaletteCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  index.clear();
+  hit_count = 0;
+  miss_count = 0;
+}
+
+std::size_t
+PaletteCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return entries.size();
+}
+
+std::size_t
+PaletteCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return hit_count;
+}
+
+std::size_t
+PaletteCache::misses() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return miss_count;
+}
+
+void
+PaletteCache::insertInMemory(const PaletteKey& key,
+                             const std::vector<colors::RGB>& palette)
+{
+  // A palette stored under the same digest is replaced, even if its
+  // fingerprint differs.
+  auto it = index.find({ key.high, key.low });
+  if (it != index.end()) {
+    *it->second = { key, palette };
+    entries.splice(entries.begin(), entries, it->second);
+    return;
+  }
+
+  entries.emplace_front(key, palette);
+  index[{ key.high, key.low }] = entries.begin();
+  if (entries.size() > max_entries) {
+    const PaletteKey& oldest = entries.back().first;
+    index.erase({ oldest.high, oldest.low });
+    entries.pop_back();
+  }
+}
+
+std::string
+PaletteCache::filePath(const PaletteKey& key) const
+{
+  return (std::filesystem::path(directory) / (key.digest() + ".pal")).string();
+}
+
+// The file holds the digest and fingerprint of the key on the first line,
+// to detect collisions, followed by one color per line as hexadecimal
+// floating-point components.
+std::optional<std::vector<colors::RGB>>
+PaletteCache::readFile(const PaletteKey& key) const
+{
+  std::ifstream in(filePath(key));
+  std::string line;
+  if (!in || !std::getline(in, line) || line != fileHeader(key)) {
+    return std::nullopt;
+  }
+
+  std::vector<colors::RGB> palette;
+  while (std::getline(in, line)) {
+    const char* p = line.c_str();
+    char* end = nullptr;
+    double rgb[3];
+    for (double& value : rgb) {
+      value = std::strtod(p, &end);
+      if (end == p || !(value >= 0.0 && value <= 1.0)) {
+        return std::nullopt;
+      }
+      p = end;
+    }
+    palette.emplace_back(rgb[0], rgb[1], rgb[2]);
+  }
+  return palette;
+}
+
+void
+PaletteCache::writeFile(const PaletteKey& key,
+                        const std::vector<colors::RGB>& palette) const
+{
+  // The temporary file is unique to this process and write, so that
+  // concurrent writers of the same key, in this or another process, never
+  // write into the same file.
+  const std::string path = filePath(key);
+  std::ostringstream tmp_path;
+  tmp_path << path << '.' << GETPID() << '.' << tmp_counter++ << ".tmp";
+
+  std::error_code ec;
+  {
+    std::ofstream out(tmp_path.str());
+    out << fileHeader(key) << '\n' << std::hexfloat;
+    for (const auto& color : palette) {
+      out << color.r() << ' ' << color.g() << ' ' << color.b() << '\n';
+    }
+    out.close();
+    if (!out) {
+      std::filesystem::remove(tmp_path.str(), ec);
+      return;
+    }
+  }
+
+  // Rename so that readers never see a partially written file.
+  std::filesystem::rename(tmp_path.str(), path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path.str(), ec);
+  }
+}
+
+} // namespace qualpal
@@ -1,59 +1,74 @@
 #include "palettes.h"
-#include "palettes_data.h"
-#include <map>
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
 
 namespace qualpal {
 
-void
-validatePalette(const std::string& palette)
+const BuiltinPalette&
+findPalette(std::string_view palette)
 {
-  std::string delimiter = ":";
-  std::size_t pos = palette.find(delimiter);
+  const std::size_t pos = palette.find(':');
 
-  if (pos == std::string::npos) {
+  if (pos == std::string_view::npos) {
     throw std::invalid_argument(
       "Invalid palette format. Expected format: 'package:palette'");
   }
 
-  std::string pkg = palette.substr(0, pos);
-  std::string pal = palette.substr(pos + delimiter.length());
+  const std::string_view pkg = palette.substr(0, pos);
+  const std::string_view pal = palette.substr(pos + 1);
+
+  const auto first = std::begin(BUILTIN_PALETTES);
+  const auto last = std::end(BUILTIN_PALETTES);
+  const auto pkg_first =
+    std::lower_bound(first, last, pkg, [](const BuiltinPalette& p, auto key) {
+      return p.package < key;
+    });
 
-  if (COLOR_PALETTES.find(pkg) == COLOR_PALETTES.end()) {
-    throw std::invalid_argument("Package '" + pkg + "' not found");
+  if (pkg_first == last || pkg_first->package != pkg) {
+    throw std::invalid_argument("Package '" + std::string(pkg) +
+                                "' not found");
   }
 
-  if (COLOR_PALETTES.at(pkg).find(pal) == COLOR_PALETTES[pkg].end()) {
-    throw std::invalid_argument("Palette '" + pal + "' not found in package '" +
-                                pkg + "'");
+  const auto it = std::lower_bound(
+    pkg_first, last, pal, [pkg](const BuiltinPalette& p, auto key) {
+      return p.package == pkg && p.name < key;
+    });
+
+  if (it == last || it->package != pkg || it->name != pal) {
+    throw std::invalid_argument("Palette '" + std::string(pal) +
+                                "' not found in package '" + std::string(pkg) +
+                                "'");
   }
+
+  return *it;
+}
+
+void
+validatePalette(const std::string& palette)
+{
+  findPalette(palette);
 }
 
 std::vector<std::string>
 getPalette(const std::string& palette)
 {
-  validatePalette(palette);
-
-  std::string delimiter = ":";
-  std::size_t pos = palette.find(delimiter);
-  std::string pkg = palette.substr(0, pos);
-  std::string pal = palette.substr(pos + delimiter.length());
+  const BuiltinPalette& pal = findPalette(palette);
 
-  return COLOR_PALETTES[pkg][pal];
+  std::vector<std::string> hex;
+  hex.reserve(pal.size());
+  for (std::size_t i = 0; i < pal.size(); ++i) {
+    hex.emplace_back(pal.hex(i));
+  }
+  return hex;
 }
 
 std::map<std::string, std::vector<std::string>>
 listAvailablePalettes()
 {
   std::map<std::string, std::vector<std::string>> result;
-  for (const auto& pkg_pair : COLOR_PALETTES) {
-    const auto& pkg = pkg_pair.first;
-    const auto& palettes = pkg_pair.second;
-    std::vector<std::string> pal_names;
-    for (const auto& pal_pair : palettes) {
-      pal_names.push_back(pal_pair.first);
-    }
-    result[pkg] = pal_names;
+  for (const auto& pal : BUILTIN_PALETTES) {
+    result[std::string(pal.package)].emplace_back(pal.name);
   }
   return result;
 }
@@ -1,9 +1,17 @@
+#include "palettes_data.h"
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace qualpal {
 
+// Looks up a built-in palette by its "package:palette" name without
+// allocating. Throws std::invalid_argument if the name is malformed or the
+// palette does not exist.
+const BuiltinPalette&
+findPalette(std::string_view palette);
+
 void
 validatePalette(const std::string& palette);
 
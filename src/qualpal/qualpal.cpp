@@ -3,15 +3,16 @@
 #include "cvd.h"
 #include "farthest_points.h"
 #include "palettes.h"
-#include "palettes_data.h"
 #include "validation.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <limits>
+#include <qualpal/color_batch.h>
 #include <qualpal/color_difference.h>
 #include <qualpal/colors.h>
 #include <qualpal/qualpal.h>
 #include <qualpal/threads.h>
-#include <random>
 #include <stdexcept>
 
 #ifdef _OPENMP
@@ -25,20 +26,16 @@ Qualpal::setInputRGB(const std::vector<colors::RGB>& colors)
 {
   this->rgb_colors_in = colors;
   this->mode = Mode::RGB;
+  this->selection_state.reset();
   return *this;
 }
 
 Qualpal&
 Qualpal::setInputHex(const std::vector<std::string>& hex_colors)
 {
-  for (const auto& color : hex_colors) {
-    if (!isValidHexColor(color)) {
-      throw std::invalid_argument("Invalid hex color: " + color +
-                                  ". Expected format: #RRGGBB or #RGB");
-    }
-  }
-  this->hex_colors = hex_colors;
+  this->rgb_colors_in = parseHexColors(hex_colors);
   this->mode = Mode::HEX;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -48,6 +45,7 @@ Qualpal::setInputPalette(const std::string& palette)
   validatePalette(palette);
   this->palette = palette;
   this->mode = Mode::PALETTE;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -106,6 +104,7 @@ Qualpal::setInputColorspaceRegions(const std::vector<ColorspaceRegion>& regions,
   this->colorspace_regions = regions;
   this->colorspace_input = space;
   this->mode = Mode::COLORSPACE;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -123,6 +122,7 @@ Qualpal::setCvd(const std::map<std::string, double>& cvd_params)
     }
   }
   this->cvd = cvd_params;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -130,6 +130,7 @@ Qualpal&
 Qualpal::setBackground(const colors::RGB& bg_color)
 {
   this->bg = bg_color;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -137,6 +138,7 @@ Qualpal&
 Qualpal::setMetric(metrics::MetricType metric)
 {
   this->metric = metric;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -147,6 +149,7 @@ Qualpal::setMemoryLimit(double gb)
     throw std::invalid_argument("Memory limit must be greater than 0");
   }
   this->max_memory = gb;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -157,6 +160,7 @@ Qualpal::setColorspaceSize(std::size_t n_points)
     throw std::invalid_argument("Number of points must be greater than 0");
   }
   this->n_points = n_points;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -164,6 +168,7 @@ Qualpal&
 Qualpal::setWhitePoint(WhitePoint wp)
 {
   this->white_point = whitePointToXYZ(wp);
+  this->selection_state.reset();
   return *this;
 }
 
@@ -171,6 +176,7 @@ Qualpal&
 Qualpal::setWhitePoint(const std::array<double, 3>& white_point)
 {
   this->white_point = white_point;
+  this->selection_state.reset();
   return *this;
 }
 
@@ -184,8 +190,83 @@ Qualpal::setRefinementStarts(int n_starts)
   return *this;
 }
 
+Qualpal&
+Qualpal::setRefinementStrategy(RefinementStrategy strategy)
+{
+  this->refinement_strategy = strategy;
+  return *this;
+}
+
+Qualpal&
+Qualpal::setLocalSearch(LocalSearch local_search)
+{
+  this->local_search = local_search;
+  return *this;
+}
+
+Qualpal&
+Qualpal::setAbandonStarts(bool abandon)
+{
+  this->abandon_starts = abandon;
+  return *this;
+}
+
+Qualpal&
+Qualpal::setSeed(std::uint64_t seed)
+{
+  this->seed = seed;
+  return *this;
+}
+
+Qualpal&
+Qualpal::setCache(std::shared_ptr<PaletteCache> cache)
+{
+  this->cache = std::move(cache);
+  return *this;
+}
+
 namespace {
 
+// Counter-based random numbers: the k-th value of a stream is a hash of the
+// seed, the stream index, and k (SplitMix64). Each refinement start has its
+// own stream, so its samples do not depend on which thread runs it or on
+// what the other starts have drawn.
+class StartRandom
+{
+public:
+  StartRandom(std::uint64_t seed, std::uint64_t stream)
+    : key(mix(seed ^ mix(stream)))
+  {
+  }
+
+  // Uniform in [lo, hi).
+  double uniform(double lo, double hi)
+  {
+    const double u = static_cast<double>(next() >> 11) * 0x1.0p-53;
+    return lo + (hi - lo) * u;
+  }
+
+  // Uniform in [0, n).
+  std::size_t index(std::size_t n)
+  {
+    return std::min(static_cast<std::size_t>(uniform(0.0, n)), n - 1);
+  }
+
+private:
+  static std::uint64_t mix(std::uint64_t x)
+  {
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+  }
+
+  std::uint64_t next() { return mix(key + 0x9e3779b97f4a7c15 * counter++); }
+
+  std::uint64_t key;
+  std::uint64_t counter = 0;
+};
+
 bool
 inSrgbGamutLinear(const colors::Lab& lab, const std::array<double, 3>& wp)
 {
@@ -234,26 +315,23 @@ labInRegion(const colors::Lab& lab,
 // Falls back to a clamped random Lab on persistent rejection so the seed
 // loop always terminates.
 colors::Lab
-sampleRandomLab(std::mt19937& rng,
+sampleRandomLab(StartRandom& rng,
                 const std::vector<ColorspaceRegion>& regions,
                 ColorspaceType space,
                 const std::array<double, 3>& wp)
 {
-  std::uniform_int_distribution<size_t> region_pick(0, regions.size() - 1);
   for (int attempt = 0; attempt < 10000; ++attempt) {
-    const auto& r = regions[region_pick(rng)];
-    std::uniform_real_distribution<double> hd(r.h_lim[0], r.h_lim[1]);
-    std::uniform_real_distribution<double> sd(r.s_or_c_lim[0],
-                                              r.s_or_c_lim[1]);
-    std::uniform_real_distribution<double> ld(r.l_lim[0], r.l_lim[1]);
-    double h = hd(rng);
+    const auto& r = regions[rng.index(regions.size())];
+    double h = rng.uniform(r.h_lim[0], r.h_lim[1]);
     if (h < 0)
       h += 360;
     if (h >= 360)
       h -= 360;
+    const double s_or_c = rng.uniform(r.s_or_c_lim[0], r.s_or_c_lim[1]);
+    const double l = rng.uniform(r.l_lim[0], r.l_lim[1]);
     colors::Lab lab = space == ColorspaceType::HSL
-                        ? colors::Lab(colors::HSL(h, sd(rng), ld(rng)))
-                        : colors::Lab(colors::LCHab(ld(rng), sd(rng), h));
+                        ? colors::Lab(colors::HSL(h, s_or_c, l))
+                        : colors::Lab(colors::LCHab(l, s_or_c, h));
     if (!inSrgbGamutLinear(lab, wp))
       continue;
     if (!labInRegion(lab, r, space))
@@ -278,7 +356,7 @@ sampleRandomLab(std::mt19937& rng,
 double
 scorePalette(const std::vector<colors::RGB>& pal,
              const std::optional<colors::RGB>& bg,
-             const std::map<std::string, double>& cvd)
+             const std::vector<CvdSimulator>& cvd)
 {
   metrics::CIEDE2000 dE;
   std::vector<colors::RGB> all = pal;
@@ -287,9 +365,8 @@ scorePalette(const std::vector<colors::RGB>& pal,
   std::vector<std::vector<colors::Lab>> views(all.size());
   for (size_t i = 0; i < all.size(); ++i) {
     views[i].emplace_back(all[i]);
-    for (const auto& [type, sev] : cvd) {
-      if (sev > 0.0)
-        views[i].emplace_back(simulateCvd(all[i], type, sev));
+    for (const auto& simulator : cvd) {
+      views[i].emplace_back(simulator.simulate(all[i]));
     }
   }
   double m = std::numeric_limits<double>::infinity();
@@ -307,27 +384,36 @@ scorePalette(const std::vector<colors::RGB>& pal,
 
 } // namespace
 
-std::vector<colors::RGB>
-Qualpal::selectColors(std::size_t n,
-                      const std::vector<colors::RGB>& fixed_palette)
+struct Qualpal::SelectionState
+{
+  std::vector<colors::RGB> fixed_palette;
+  std::size_t n_candidates;
+  // The fixed palette, then the candidates, then the background (if any).
+  std::vector<colors::RGB> rgb_colors;
+  std::vector<colors::XYZ> xyz_colors;
+  CandidateDistances distances;
+};
+
+std::shared_ptr<const Qualpal::SelectionState>
+Qualpal::makeSelectionState(const std::vector<colors::RGB>& fixed_palette)
 {
   switch (mode) {
     case Mode::RGB:
       break;
     case Mode::HEX:
-      rgb_colors_in.clear();
-      rgb_colors_in.reserve(n_points);
-      for (const auto& hex : hex_colors) {
-        rgb_colors_in.emplace_back(hex);
-      }
+      // Parsed by setInputHex()
       break;
-    case Mode::PALETTE:
+    case Mode::PALETTE: {
+      const BuiltinPalette& pal = findPalette(palette);
       rgb_colors_in.clear();
-      rgb_colors_in.reserve(n_points);
-      for (const auto& hex : getPalette(palette)) {
-        rgb_colors_in.emplace_back(hex);
+      rgb_colors_in.reserve(pal.size());
+      for (std::size_t i = 0; i < pal.size(); ++i) {
+        const auto rgb = pal.rgb(i);
+        rgb_colors_in.emplace_back(
+          rgb[0] / 255.0, rgb[1] / 255.0, rgb[2] / 255.0);
       }
       break;
+    }
     case Mode::COLORSPACE: {
       rgb_colors_in.clear();
 
@@ -368,6 +454,37 @@ Qualpal::selectColors(std::size_t n,
     throw std::runtime_error("No input colors provided.");
   }
 
+  bool has_bg = bg.has_value();
+
+  std::vector<colors::RGB> rgb_colors;
+  rgb_colors.reserve(fixed_palette.size() + rgb_colors_in.size() +
+                     (has_bg ? 1 : 0));
+  rgb_colors.insert(
+    rgb_colors.end(), fixed_palette.begin(), fixed_palette.end());
+  rgb_colors.insert(
+    rgb_colors.end(), rgb_colors_in.begin(), rgb_colors_in.end());
+  if (has_bg) {
+    rgb_colors.push_back(*bg);
+  }
+
+  // Convert colors to XYZ for distance calculations
+  std::vector<colors::XYZ> xyz_colors = colors::toXYZ(rgb_colors);
+
+  CandidateDistances distances(
+    xyz_colors, metric, max_memory, white_point, cvd);
+
+  return std::make_shared<const SelectionState>(
+    SelectionState{ fixed_palette,
+                    rgb_colors_in.size(),
+                    std::move(rgb_colors),
+                    std::move(xyz_colors),
+                    std::move(distances) });
+}
+
+std::vector<colors::RGB>
+Qualpal::selectColors(std::size_t n,
+                      const std::vector<colors::RGB>& fixed_palette)
+{
   std::size_t n_fixed = fixed_palette.size();
 
   if (n < n_fixed) {
@@ -379,36 +496,112 @@ Qualpal::selectColors(std::size_t n,
     throw std::invalid_argument("Number of new colors to add is negative.");
   }
 
+  // The candidates and their distances only depend on the configuration and
+  // the fixed palette, so they are kept for later calls.
+  if (!selection_state || selection_state->fixed_palette != fixed_palette) {
+    // Release the old distances before building the new ones.
+    selection_state.reset();
+    selection_state = makeSelectionState(fixed_palette);
+  }
+
   std::size_t n_new = n - n_fixed;
 
-  if (rgb_colors_in.size() < n_new) {
+  if (selection_state->n_candidates < n_new) {
     throw std::invalid_argument(
       "Requested number of colors exceeds input size");
   }
 
-  bool has_bg = bg.has_value();
+  // Select new colors (CVD-aware if CVD parameters are set)
+  auto ind = farthestPoints(
+    n, selection_state->distances, bg.has_value(), n_fixed);
 
-  std::vector<colors::RGB> rgb_colors;
-  rgb_colors.reserve(fixed_palette.size() + rgb_colors_in.size() +
-                     (has_bg ? 1 : 0));
-  rgb_colors.insert(
-    rgb_colors.end(), fixed_palette.begin(), fixed_palette.end());
-  rgb_colors.insert(
-    rgb_colors.end(), rgb_colors_in.begin(), rgb_colors_in.end());
-  if (has_bg) {
-    rgb_colors.push_back(*bg);
+  return finishPalette(ind, n_fixed);
+}
+
+std::vector<std::vector<colors::RGB>>
+Qualpal::generateSequence(std::size_t max_n)
+{
+  std::vector<std::vector<colors::RGB>> palettes(max_n);
+  std::vector<PaletteKey> keys;
+
+  // Palette n only depends on the configuration and n, so cached palettes
+  // are used as they are, and the distances are only built when one of them
+  // is missing.
+  bool complete = false;
+  if (cache && max_n > 0) {
+    complete = true;
+    keys.reserve(max_n);
+    for (std::size_t n = 1; n <= max_n; ++n) {
+      keys.push_back(cacheKey(n, {}, true));
+      if (auto palette = cache->find(keys.back())) {
+        palettes[n - 1] = std::move(*palette);
+      } else {
+        complete = false;
+      }
+    }
+  }
+  if (complete) {
+    return palettes;
   }
 
-  // Convert colors to XYZ for distance calculations
-  std::vector<colors::XYZ> xyz_colors;
-  xyz_colors.reserve(rgb_colors.size());
-  for (const auto& c : rgb_colors) {
-    xyz_colors.emplace_back(c);
+  if (!selection_state || !selection_state->fixed_palette.empty()) {
+    selection_state.reset();
+    selection_state = makeSelectionState({});
   }
 
-  // Select new colors (CVD-aware if CVD parameters are set)
-  auto ind = farthestPoints(
-    n, xyz_colors, metric, has_bg, n_fixed, max_memory, white_point, cvd);
+  if (selection_state->n_candidates < max_n) {
+    throw std::invalid_argument(
+      "Requested number of colors exceeds input size");
+  }
+
+  // The colors are taken in farthest-first order. Each palette keeps the
+  // previous one as it is and adds the next color, refined on its own
+  // against the colors already chosen.
+  const auto order =
+    farthestFirst(max_n, selection_state->distances, bg.has_value());
+  for (std::size_t n = 1; n <= max_n; ++n) {
+    if (!palettes[n - 1].empty()) {
+      continue;
+    }
+    if (n == 1) {
+      palettes[0] = finishPalette({ order[0] }, 0);
+    } else {
+      std::vector<colors::RGB> rgb = palettes[n - 2];
+      std::vector<colors::XYZ> xyz = colors::toXYZ(rgb);
+      rgb.push_back(selection_state->rgb_colors[order[n - 1]]);
+      xyz.push_back(selection_state->xyz_colors[order[n - 1]]);
+      palettes[n - 1] = refineColors(std::move(rgb), std::move(xyz), n - 1);
+    }
+    if (cache) {
+      cache->insert(keys[n - 1], palettes[n - 1]);
+    }
+  }
+  return palettes;
+}
+
+std::vector<colors::RGB>
+Qualpal::finishPalette(const std::vector<std::size_t>& ind,
+                       std::size_t n_fixed) const
+{
+  std::vector<colors::RGB> rgb;
+  std::vector<colors::XYZ> xyz;
+  rgb.reserve(ind.size());
+  xyz.reserve(ind.size());
+  for (const auto& i : ind) {
+    rgb.push_back(selection_state->rgb_colors[i]);
+    xyz.push_back(selection_state->xyz_colors[i]);
+  }
+  return refineColors(std::move(rgb), std::move(xyz), n_fixed);
+}
+
+std::vector<colors::RGB>
+Qualpal::refineColors(std::vector<colors::RGB> rgb,
+                      std::vector<colors::XYZ> xyz,
+                      std::size_t n_fixed) const
+{
+  const std::size_t n = rgb.size();
+  const bool has_bg = bg.has_value();
+  const auto& xyz_colors = selection_state->xyz_colors;
 
   // Continuous refinement only runs when the input is a colorspace region:
   // refining off-grid for fixed input sets (RGB/hex/named palette) would
@@ -418,15 +611,13 @@ Qualpal::selectColors(std::size_t n,
 
   if (do_refine) {
     const std::size_t n_total = n + (has_bg ? 1 : 0);
+    const auto simulators = cvdSimulators(cvd);
 
     // Seed 0: discrete warm start + refine. Preserve the original RGB for
     // points that didn't move (XYZ→RGB roundtrip drift on out-of-gamut
     // candidates is non-trivial).
-    std::vector<colors::XYZ> seed0_xyz;
+    std::vector<colors::XYZ> seed0_xyz = xyz;
     seed0_xyz.reserve(n_total);
-    for (std::size_t i = 0; i < n; ++i) {
-      seed0_xyz.push_back(xyz_colors[ind[i]]);
-    }
     if (has_bg) {
       seed0_xyz.push_back(xyz_colors.back());
     }
@@ -436,14 +627,17 @@ Qualpal::selectColors(std::size_t n,
                                   colorspace_regions,
                                   colorspace_input,
                                   white_point,
-                                  cvd);
+                                  simulators,
+                                  -std::numeric_limits<double>::infinity(),
+                                  refinement_strategy,
+                                  local_search);
     std::vector<colors::RGB> seed0_pal;
     seed0_pal.reserve(n);
     for (std::size_t i = 0; i < n; ++i) {
       if (refined0.moved[i]) {
         seed0_pal.emplace_back(refined0.selected[i]);
       } else {
-        seed0_pal.emplace_back(rgb_colors[ind[i]]);
+        seed0_pal.emplace_back(rgb[i]);
       }
     }
 
@@ -463,17 +657,26 @@ Qualpal::selectColors(std::size_t n,
     // every random seed; only the movable slice is resampled.
     std::vector<colors::XYZ> prefix_suffix(n_total);
     for (std::size_t i = 0; i < n_fixed; ++i) {
-      prefix_suffix[i] = xyz_colors[i];
+      prefix_suffix[i] = xyz[i];
     }
     if (has_bg) {
       prefix_suffix[n_total - 1] = xyz_colors.back();
     }
 
+    // When requested, seeds that seem to fall behind the warm start are
+    // abandoned early (a heuristic, see setAbandonStarts()). The score to
+    // beat is fixed before any seed runs, and the winner is picked by index
+    // below, so the palette does not depend on the number of threads or on
+    // the order in which the seeds finish.
+    const double best_refined = abandon_starts
+                                  ? refined0.score
+                                  : -std::numeric_limits<double>::infinity();
+
 #ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic) num_threads(Threads::get())
+#pragma omp parallel for schedule(dynamic, 1) num_threads(Threads::get())
 #endif
     for (int s = 0; s < n_extra; ++s) {
-      std::mt19937 rng(static_cast<uint64_t>(s) + 1);
+      StartRandom rng(seed, static_cast<std::uint64_t>(s));
       std::vector<colors::XYZ> seed_xyz = prefix_suffix;
       for (std::size_t i = n_fixed; i < n; ++i) {
         colors::Lab lab = sampleRandomLab(
@@ -486,24 +689,31 @@ Qualpal::selectColors(std::size_t n,
                                      colorspace_regions,
                                      colorspace_input,
                                      white_point,
-                                     cvd);
+                                     simulators,
+                                     best_refined,
+                                     refinement_strategy,
+                                     local_search);
+      if (refined_s.abandoned) {
+        continue;
+      }
+
       std::vector<colors::RGB> pal;
       pal.reserve(n);
       for (std::size_t i = 0; i < n; ++i) {
         // Fixed colors must round-trip exactly — use their original RGB
         // rather than RGB(XYZ(rgb)), which would drift on the gamut edge.
         if (i < n_fixed) {
-          pal.emplace_back(rgb_colors[i]);
+          pal.emplace_back(rgb[i]);
         } else {
           pal.emplace_back(refined_s.selected[i]);
         }
       }
-      double sc = scorePalette(pal, bg, cvd);
+      double sc = scorePalette(pal, bg, simulators);
       palettes[s] = std::move(pal);
       scores[s] = sc;
     }
 
-    double best_score = scorePalette(seed0_pal, bg, cvd);
+    double best_score = scorePalette(seed0_pal, bg, simulators);
     std::vector<colors::RGB>* best = &seed0_pal;
     for (int s = 0; s < n_extra; ++s) {
       if (scores[s] > best_score) {
@@ -515,24 +725,109 @@ Qualpal::selectColors(std::size_t n,
   }
 
   // Output: fixed_palette + selected new colors
-  std::vector<colors::RGB> result;
-  for (const auto& i : ind) {
-    result.emplace_back(rgb_colors[i]);
+  return rgb;
+}
+
+// Key of everything that determines the palette. Input colors enter as
+// parsed RGB values, so hex input and the same colors given as RGB share a
+// key. Values are hashed exactly, and each list is preceded by its length.
+PaletteKey
+Qualpal::cacheKey(std::size_t n,
+                  const std::vector<colors::RGB>& fixed_palette,
+                  bool sequence) const
+{
+  PaletteKeyBuilder key;
+
+  auto addColor = [&key](const colors::RGB& color) {
+    key.addNumber(color.r()).addNumber(color.g()).addNumber(color.b());
+  };
+  auto addColors = [&](const std::vector<colors::RGB>& rgb) {
+    key.addInteger(rgb.size());
+    for (const auto& color : rgb) {
+      addColor(color);
+    }
+  };
+
+  switch (mode) {
+    case Mode::RGB:
+    case Mode::HEX:
+      key.addString("rgb");
+      addColors(rgb_colors_in);
+      break;
+    case Mode::PALETTE:
+      key.addString("palette").addString(palette);
+      break;
+    case Mode::COLORSPACE:
+      key.addString("colorspace")
+        .addString(colorspace_input == ColorspaceType::HSL ? "hsl" : "lchab")
+        .addInteger(n_points)
+        .addInteger(colorspace_regions.size());
+      for (const auto& r : colorspace_regions) {
+        key.addNumber(r.h_lim[0])
+          .addNumber(r.h_lim[1])
+          .addNumber(r.s_or_c_lim[0])
+          .addNumber(r.s_or_c_lim[1])
+          .addNumber(r.l_lim[0])
+          .addNumber(r.l_lim[1]);
+      }
+      break;
+    case Mode::NONE:
+      key.addString("none");
+      break;
   }
 
-  return result;
+  key.addInteger(cvd.size());
+  for (const auto& [type, severity] : cvd) {
+    key.addString(type).addNumber(severity);
+  }
+  key.addInteger(bg.has_value());
+  if (bg) {
+    addColor(*bg);
+  }
+  key.addInteger(static_cast<std::uint64_t>(metric))
+    .addNumber(max_memory)
+    .addNumber(white_point[0])
+    .addNumber(white_point[1])
+    .addNumber(white_point[2])
+    .addInteger(static_cast<std::uint64_t>(n_refinement_starts))
+    .addInteger(static_cast<std::uint64_t>(refinement_strategy))
+    .addInteger(static_cast<std::uint64_t>(local_search))
+    .addInteger(abandon_starts)
+    .addInteger(seed)
+    .addInteger(n)
+    .addInteger(sequence);
+  addColors(fixed_palette);
+
+  return key.key();
+}
+
+std::vector<colors::RGB>
+Qualpal::selectCachedColors(std::size_t n,
+                            const std::vector<colors::RGB>& fixed_palette)
+{
+  if (!cache) {
+    return selectColors(n, fixed_palette);
+  }
+
+  const PaletteKey key = cacheKey(n, fixed_palette);
+  if (auto palette = cache->find(key)) {
+    return *palette;
+  }
+  auto palette = selectColors(n, fixed_palette);
+  cache->insert(key, palette);
+  return palette;
 }
 
 std::vector<colors::RGB>
 Qualpal::generate(std::size_t n)
 {
-  return selectColors(n);
+  return selectCachedColors(n);
 }
 
 std::vector<colors::RGB>
 Qualpal::extend(const std::vector<colors::RGB>& palette, std::size_t n)
 {
-  return selectColors(n, palette);
+  return selectCachedColors(n, palette);
 }
 
 } // namespace qualpal
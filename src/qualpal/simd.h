@@ -0,0 +1,211 @@
+#pragma once
+
+// Helpers for the vectorized batch kernels. Files using them are built with
+// -fno-math-errno, -fno-trapping-math and -ffp-contract=off (see
+// src/CMakeLists.txt), so that their loops vectorize and give the same bits
+// on every instruction set.
+
+// <cmath> also defines __GLIBC__, which the check below relies on.
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Runtime dispatch between AVX-512, AVX2 and baseline builds of a kernel.
+// Elsewhere kernels are compiled once for the target architecture (on
+// AArch64 that means NEON).
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__GLIBC__) &&         \
+  defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define QUALPAL_TARGET_CLONES                                                  \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+
+#ifndef QUALPAL_TARGET_CLONES
+#define QUALPAL_TARGET_CLONES
+#endif
+
+// Helpers must be inlined into a loop for it to vectorize.
+#if defined(__GNUC__)
+#define QUALPAL_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define QUALPAL_ALWAYS_INLINE __forceinline
+#else
+#define QUALPAL_ALWAYS_INLINE inline
+#endif
+
+namespace qualpal {
+namespace detail {
+
+// Branch-free building blocks for the kernels. They avoid libm so that loops
+// calling them vectorize.
+
+constexpr double two52 = 4503599627370496.0;
+
+QUALPAL_ALWAYS_INLINE std::uint64_t
+toBits(double x)
+{
+  std::uint64_t u;
+  std::memcpy(&u, &x, sizeof(u));
+  return u;
+}
+
+QUALPAL_ALWAYS_INLINE double
+fromBits(std::uint64_t u)
+{
+  double x;
+  std::memcpy(&x, &u, sizeof(x));
+  return x;
+}
+
+// Round to the nearest integer (ties to even) for |x| < 2^51, without
+// relying on SSE4.1 rounding instructions.
+QUALPAL_ALWAYS_INLINE double
+roundToInt(double x)
+{
+  return (x + 1.5 * two52) - 1.5 * two52;
+}
+
+// Unbiased binary exponent and the significand in [1, 2) of a positive
+// normal number.
+QUALPAL_ALWAYS_INLINE void
+decompose(double x, double& exponent, double& significand)
+{
+  const std::uint64_t u = toBits(x);
+  exponent = fromBits(0x4330000000000000ULL | (u >> 52)) - two52 - 1023.0;
+  significand =
+    fromBits((u & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+}
+
+// 2^k for an integer k in the normal exponent range.
+QUALPAL_ALWAYS_INLINE double
+pow2(double k)
+{
+  return fromBits((toBits((k + 1023.0) + two52) & 0x7FFULL) << 52);
+}
+
+// Cube root of a positive normal number.
+QUALPAL_ALWAYS_INLINE double
+cbrtPositive(double x)
+{
+  double e, m;
+  decompose(x, e, m);
+
+  // Split the exponent into 3q + r with r in {0, 1, 2} and fold 2^r into the
+  // significand, which is then in [1, 8).
+  const double q = roundToInt((e - 1.0) / 3.0);
+  const double r = e - 3.0 * q;
+  const double s = m * pow2(r);
+
+  // Quadratic through (1, 1), (3.375, 1.5) and (8, 2), then two Halley steps
+  // and a final Newton step.
+  double y = (-0.014631172525909366 * s + 0.27453769559032715) * s +
+             0.7400934769355823;
+  double y3 = y * y * y;
+  y = y * (y3 + 2.0 * s) / (2.0 * y3 + s);
+  y3 = y * y * y;
+  y = y * (y3 + 2.0 * s) / (2.0 * y3 + s);
+  y = y + (s / (y * y) - y) / 3.0;
+
+  return y * pow2(q);
+}
+
+constexpr double ln2_hi = 6.93147180369123816490e-01;
+constexpr double ln2_lo = 1.90821492927058770002e-10;
+
+// Splits log(x) for a positive normal x into e * log(2) + log_m, where
+// log_m is the logarithm of a significand in [sqrt(1/2), sqrt(2)).
+QUALPAL_ALWAYS_INLINE void
+logSplit(double x, double& e, double& log_m)
+{
+  constexpr double sqrt2 = 1.41421356237309504880;
+
+  double m;
+  decompose(x, e, m);
+  const bool high = m > sqrt2;
+  m = high ? 0.5 * m : m;
+  e = high ? e + 1.0 : e;
+
+  // log(m) = 2 atanh(s) with |s| <= 0.172.
+  const double s = (m - 1.0) / (m + 1.0);
+  const double z = s * s;
+  double p = 1.0 / 23;
+  p = p * z + 1.0 / 21;
+  p = p * z + 1.0 / 19;
+  p = p * z + 1.0 / 17;
+  p = p * z + 1.0 / 15;
+  p = p * z + 1.0 / 13;
+  p = p * z + 1.0 / 11;
+  p = p * z + 1.0 / 9;
+  p = p * z + 1.0 / 7;
+  p = p * z + 1.0 / 5;
+  p = p * z + 1.0 / 3;
+  log_m = 2.0 * s + 2.0 * s * (z * p);
+}
+
+// log(x) for a positive normal x.
+QUALPAL_ALWAYS_INLINE double
+logPositive(double x)
+{
+  double e, log_m;
+  logSplit(x, e, log_m);
+  return e * ln2_hi + (log_m + e * ln2_lo);
+}
+
+// log1p(x) for x >= 0, via log(1 + x) corrected for the rounding of 1 + x.
+QUALPAL_ALWAYS_INLINE double
+log1pNonNegative(double x)
+{
+  const double u = 1.0 + x;
+  const double c = (u - 1.0) - x;
+
+  double e, log_m;
+  logSplit(u, e, log_m);
+  return e * ln2_hi + ((log_m - c / u) + e * ln2_lo);
+}
+
+// exp(x) for |x| <= 700: exp(r) * 2^k with x = k log(2) + r, |r| <= 0.35.
+QUALPAL_ALWAYS_INLINE double
+expBounded(double x)
+{
+  const double k = roundToInt(x * 1.44269504088896340736);
+  const double r = (x - k * ln2_hi) - k * ln2_lo;
+  double p = 1.0 / 6227020800;
+  p = p * r + 1.0 / 479001600;
+  p = p * r + 1.0 / 39916800;
+  p = p * r + 1.0 / 3628800;
+  p = p * r + 1.0 / 362880;
+  p = p * r + 1.0 / 40320;
+  p = p * r + 1.0 / 5040;
+  p = p * r + 1.0 / 720;
+  p = p * r + 1.0 / 120;
+  p = p * r + 1.0 / 24;
+  p = p * r + 1.0 / 6;
+  p = p * r + 1.0 / 2;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+  return p * pow2(k);
+}
+
+// Linear sRGB component to its companded value, as in RGB(const XYZ&).
+QUALPAL_ALWAYS_INLINE double
+compandSrgb(double v)
+{
+  constexpr double threshold = 0.0031308;
+  const double powered = expBounded(
+    logPositive(v > threshold ? v : threshold) * (1 / 2.4));
+  return v > threshold ? 1.055 * powered - 0.055 : 12.92 * v;
+}
+
+// Companded sRGB component to linear light, as in XYZ(const RGB&).
+QUALPAL_ALWAYS_INLINE double
+linearizeSrgb(double v)
+{
+  constexpr double threshold = 0.04045;
+  const double base = ((v > threshold ? v : threshold) + 0.055) / 1.055;
+  const double powered = expBounded(logPositive(base) * 2.4);
+  return v <= threshold ? v / 12.92 : powered;
+}
+
+} // namespace detail
+} // namespace qualpal
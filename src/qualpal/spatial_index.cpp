@@ -0,0 +1,72 @@
+#include "spatial_index.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace qualpal {
+
+LabGrid::LabGrid(const double* l,
+                 const double* a,
+                 const double* b,
+                 const std::size_t n,
+                 const std::size_t points_per_cell)
+  : cell_of(n)
+{
+  const std::array<const double*, 3> coords = { l, a, b };
+
+  std::array<double, 3> extent{};
+  double max_extent = 0.0;
+  for (int dim = 0; dim < 3; ++dim) {
+    double lo = std::numeric_limits<double>::max();
+    double hi = std::numeric_limits<double>::lowest();
+    for (std::size_t i = 0; i < n; ++i) {
+      lo = std::min(lo, coords[dim][i]);
+      hi = std::max(hi, coords[dim][i]);
+    }
+    origin[dim] = n > 0 ? lo : 0.0;
+    extent[dim] = n > 0 ? hi - lo : 0.0;
+    max_extent = std::max(max_extent, extent[dim]);
+  }
+
+  // Pick the side so that the cells of the bounding box hold
+  // `points_per_cell` points on average. Flat axes are widened so that a
+  // set of colors with, say, fixed lightness still gets a sensible side.
+  if (max_extent > 0.0) {
+    double volume = 1.0;
+    for (double e : extent) {
+      volume *= std::max(e, max_extent / 1024.0);
+    }
+    const double per_cell =
+      static_cast<double>(std::max<std::size_t>(points_per_cell, 1));
+    cell_size = std::cbrt(volume * per_cell / static_cast<double>(n));
+    cell_size = std::max(cell_size, max_extent / 1024.0);
+  }
+  for (int dim = 0; dim < 3; ++dim) {
+    dims[dim] = static_cast<std::size_t>(extent[dim] / cell_size) + 1;
+  }
+
+  // Counting sort of the points by cell, which keeps the points of each cell
+  // in increasing index order.
+  cell_start.assign(n_cells() + 1, 0);
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t c = 0;
+    for (int dim = 2; dim >= 0; --dim) {
+      const auto k = static_cast<std::size_t>(
+        (coords[dim][i] - origin[dim]) / cell_size);
+      c = c * dims[dim] + std::min(k, dims[dim] - 1);
+    }
+    cell_of[i] = c;
+    ++cell_start[c + 1];
+  }
+  for (std::size_t c = 0; c < n_cells(); ++c) {
+    cell_start[c + 1] += cell_start[c];
+  }
+
+  points.resize(n);
+  std::vector<std::size_t> next(cell_start.begin(), cell_start.end() - 1);
+  for (std::size_t i = 0; i < n; ++i) {
+    points[next[cell_of[i]]++] = i;
+  }
+}
+
+} // namespace qualpal
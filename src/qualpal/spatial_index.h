@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace qualpal {
+
+// Uniform grid over points in a Euclidean color space, such as Lab or
+// DIN99d. The bounding box of the points is divided into cubic cells holding
+// about `points_per_cell` points on average, and the points of each cell are
+// stored contiguously in increasing index order. Cells are numbered so that
+// neighboring cells in the lightness direction are adjacent.
+//
+// The grid only serves the exchange loop of farthestPoints(), which bounds
+// the distances within each cell and skips the cells that cannot hold a
+// better color. It has no range queries: continuous refinement compares
+// each position with the few colors of the palette only, and the CIEDE2000
+// lower bounds already prune those comparisons.
+class LabGrid
+{
+public:
+  // The points of one cell.
+  struct Range
+  {
+    const std::size_t* first;
+    const std::size_t* last;
+
+    const std::size_t* begin() const { return first; }
+    const std::size_t* end() const { return last; }
+    std::size_t size() const { return last - first; }
+  };
+
+  LabGrid() = default;
+
+  LabGrid(const double* l,
+          const double* a,
+          const double* b,
+          const std::size_t n,
+          const std::size_t points_per_cell = 32);
+
+  std::size_t size() const { return cell_of.size(); }
+  std::size_t cellCount() const { return cell_start.empty() ? 0 : n_cells(); }
+
+  std::size_t cellOf(const std::size_t i) const { return cell_of[i]; }
+
+  Range cell(const std::size_t c) const
+  {
+    return { points.data() + cell_start[c],
+             points.data() + cell_start[c + 1] };
+  }
+
+private:
+  std::size_t n_cells() const { return dims[0] * dims[1] * dims[2]; }
+
+  std::array<double, 3> origin{};
+  std::array<std::size_t, 3> dims{};
+  double cell_size = 1.0;
+
+  std::vector<std::size_t> cell_of;
+  std::vector<std::size_t> cell_start;
+  std::vector<std::size_t> points;
+};
+
+} // namespace qualpal
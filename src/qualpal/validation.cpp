@@ -1,14 +1,109 @@
 #include "validation.h"
+#include <algorithm>
 #include <array>
-#include <regex>
+#include <stdexcept>
 
 namespace qualpal {
 
+namespace {
+
+constexpr unsigned char not_hex = 0xff;
+
+// Value of every byte as a hexadecimal digit, or not_hex.
+constexpr std::array<unsigned char, 256>
+makeHexDigitTable()
+{
+  std::array<unsigned char, 256> table{};
+  for (int c = 0; c < 256; ++c) {
+    table[c] = not_hex;
+  }
+  for (int k = 0; k < 10; ++k) {
+    table['0' + k] = static_cast<unsigned char>(k);
+  }
+  for (int k = 0; k < 6; ++k) {
+    table['a' + k] = static_cast<unsigned char>(10 + k);
+    table['A' + k] = static_cast<unsigned char>(10 + k);
+  }
+  return table;
+}
+
+constexpr std::array<unsigned char, 256> hex_digits = makeHexDigitTable();
+
+} // namespace
+
+std::optional<HexColorError>
+parseHexColor(std::string_view hex, std::array<unsigned char, 3>& rgb)
+{
+  if (hex.empty() || hex[0] != '#') {
+    return HexColorError{ 0, "expected '#' at position 0" };
+  }
+
+  std::array<unsigned char, 6> digits;
+  const std::size_t n_digits = hex.size() - 1;
+  for (std::size_t i = 0; i < n_digits; ++i) {
+    const auto c = static_cast<unsigned char>(hex[i + 1]);
+    const unsigned char digit = hex_digits[c];
+    if (digit == not_hex) {
+      return HexColorError{ i + 1,
+                            "'" + std::string(1, hex[i + 1]) +
+                              "' at position " + std::to_string(i + 1) +
+                              " is not a hexadecimal digit" };
+    }
+    if (i < digits.size()) {
+      digits[i] = digit;
+    }
+  }
+
+  if (n_digits == 6) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      rgb[k] =
+        static_cast<unsigned char>(16 * digits[2 * k] + digits[2 * k + 1]);
+    }
+  } else if (n_digits == 3) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      rgb[k] = static_cast<unsigned char>(17 * digits[k]);
+    }
+  } else {
+    return HexColorError{ std::min<std::size_t>(hex.size(), 7),
+                          "expected 3 or 6 hexadecimal digits after '#', got " +
+                            std::to_string(n_digits) };
+  }
+
+  return std::nullopt;
+}
+
+std::string
+hexColorErrorMessage(const std::string& hex, const HexColorError& error)
+{
+  return "Invalid hex color '" + hex + "': " + error.reason +
+         ". Expected format: #RRGGBB or #RGB";
+}
+
+std::vector<colors::RGB>
+parseHexColors(const std::vector<std::string>& hex)
+{
+  std::vector<colors::RGB> result;
+  result.reserve(hex.size());
+
+  std::array<unsigned char, 3> rgb;
+  for (std::size_t i = 0; i < hex.size(); ++i) {
+    if (const auto error = parseHexColor(hex[i], rgb)) {
+      throw std::invalid_argument("Invalid hex color '" + hex[i] +
+                                  "' at index " + std::to_string(i) + ": " +
+                                  error->reason +
+                                  ". Expected format: #RRGGBB or #RGB");
+    }
+    result.emplace_back(rgb[0] / 255.0, rgb[1] / 255.0, rgb[2] / 255.0);
+  }
+
+  return result;
+}
+
 bool
 isValidHexColor(const std::string& color)
 {
-  std::regex color_regex("^#([A-Fa-f0-9]{6}|[A-Fa-f0-9]{3})$");
-  return std::regex_match(color, color_regex);
+  std::array<unsigned char, 3> rgb;
+  return !parseHexColor(color, rgb);
 }
 
 void
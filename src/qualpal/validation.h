@@ -1,10 +1,38 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <optional>
+#include <qualpal/colors.h>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace qualpal {
 
+// Why a hex color string is invalid: the offset of the first offending
+// character (the length of the string if it is too short) and a description.
+struct HexColorError
+{
+  std::size_t position;
+  std::string reason;
+};
+
+// Validates and parses "#RRGGBB" or "#RGB", in either case, in one pass
+// over the string. On success `rgb` holds the 8-bit components.
+std::optional<HexColorError>
+parseHexColor(std::string_view hex, std::array<unsigned char, 3>& rgb);
+
+// Error message for an invalid hex color.
+std::string
+hexColorErrorMessage(const std::string& hex, const HexColorError& error);
+
+// Validates and parses a list of hex colors.
+// Throws std::invalid_argument naming the first invalid color, its index,
+// and the offending character.
+std::vector<colors::RGB>
+parseHexColors(const std::vector<std::string>& hex);
+
 bool
 isValidHexColor(const std::string& color);
 
@@ -1,10 +1,12 @@
 #include "../src/qualpal/color_grid.h"
+#include "../src/qualpal/validation.h"
 #include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers.hpp>
 #include <cmath>
 #include <qualpal/color_difference.h>
 #include <qualpal/qualpal.h>
+#include <string>
 
 TEST_CASE("Parallelization", "[!benchmark]")
 {
@@ -35,6 +37,31 @@ TEST_CASE("Parallelization", "[!benchmark]")
   };
 }
 
+TEST_CASE("Color difference matrix thread scaling", "[!benchmark]")
+{
+  auto hsl_colors = qualpal::colorGrid<qualpal::colors::HSL>(
+    { -360.0, 360.0 }, { 0.0, 1.0 }, { 0.0, 1.0 }, 4000);
+
+  std::vector<qualpal::colors::Lab> lab_colors;
+
+  for (auto color : hsl_colors) {
+    lab_colors.emplace_back(color);
+  }
+
+  const auto n_threads = qualpal::Threads::get();
+
+  for (std::size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+    qualpal::Threads::set(threads);
+    BENCHMARK(std::to_string(threads) + " threads")
+    {
+      return qualpal::colorDifferenceMatrix(lab_colors,
+                                            qualpal::metrics::CIEDE2000{});
+    };
+  }
+
+  qualpal::Threads::set(n_threads);
+}
+
 TEST_CASE("Color Difference Metrics", "[!benchmark]")
 {
   std::array<double, 2> h_lim = { -360.0, 360.0 };
@@ -85,3 +112,20 @@ TEST_CASE("Palette sizes", "[!benchmark]")
     qp.generate(100);
   };
 }
+
+TEST_CASE("Hex parsing", "[!benchmark]")
+{
+  std::vector<std::string> hex;
+  hex.reserve(1000000);
+  for (std::size_t i = 0; i < 1000000; ++i) {
+    hex.push_back(qualpal::colors::RGB((i % 256) / 255.0,
+                                       ((i / 256) % 256) / 255.0,
+                                       ((i / 65536) % 256) / 255.0)
+                    .hex());
+  }
+
+  BENCHMARK("1M hex colors")
+  {
+    return qualpal::parseHexColors(hex);
+  };
+}
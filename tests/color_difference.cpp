@@ -1,6 +1,8 @@
 #include "../src/qualpal/color_grid.h"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cstdint>
+#include <qualpal/color_batch.h>
 #include <qualpal/color_difference.h>
 #include <qualpal/metrics.h>
 
@@ -25,3 +27,149 @@ TEST_CASE("Color difference matrices", "[colordiff]")
   REQUIRE_NOTHROW(
     qualpal::colorDifferenceMatrix(colors, qualpal::metrics::CIE76{}));
 }
+
+TEST_CASE("Packed color difference matrices match the full matrix",
+          "[colordiff]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+  using namespace Catch::Matchers;
+
+  auto hsl_colors = colorGrid<HSL>({ 0, 360 }, { 0.2, 0.8 }, { 0.3, 0.7 }, 40);
+
+  std::vector<XYZ> xyz_colors;
+  for (const auto& hsl : hsl_colors) {
+    xyz_colors.emplace_back(hsl);
+  }
+
+  for (auto metric : { metrics::MetricType::DIN99d,
+                       metrics::MetricType::CIEDE2000,
+                       metrics::MetricType::CIE76 }) {
+    auto full = colorDifferenceMatrix(xyz_colors, metric);
+    auto packed = symmetricColorDifferenceMatrix(xyz_colors, metric);
+
+    REQUIRE(packed.nrow() == full.nrow());
+
+    for (std::size_t i = 0; i < full.nrow(); ++i) {
+      for (std::size_t j = 0; j < full.ncol(); ++j) {
+        REQUIRE(packed(i, j) == static_cast<float>(full(i, j)));
+      }
+    }
+  }
+}
+
+TEST_CASE("Packed float matrices fit more colors in the same memory",
+          "[colordiff]")
+{
+  using namespace qualpal::detail;
+
+  const std::size_t n = 10000;
+
+  REQUIRE(estimateSymmetricMatrixMemory<float>(n) ==
+          n * (n + 1) / 2 * sizeof(float));
+
+  // Twice as many colors need about the same memory as the full double
+  // matrix.
+  REQUIRE(checkSymmetricMatrixSize<float>(2 * n, 0.75));
+  REQUIRE_FALSE(checkMatrixSize(2 * n, 0.75));
+}
+
+TEST_CASE("Multi-view matrices take the minimum over views", "[colordiff]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+
+  auto hsl_colors = colorGrid<HSL>({ 0, 360 }, { 0.2, 0.8 }, { 0.3, 0.7 }, 30);
+
+  std::vector<std::vector<XYZ>> views(3);
+  for (const auto& hsl : hsl_colors) {
+    RGB rgb(hsl);
+    views[0].emplace_back(rgb);
+    views[1].emplace_back(RGB(rgb.g(), rgb.g(), rgb.b()));
+    views[2].emplace_back(RGB(rgb.r(), rgb.r(), rgb.b()));
+  }
+
+  for (auto metric : { metrics::MetricType::DIN99d,
+                       metrics::MetricType::CIEDE2000,
+                       metrics::MetricType::CIE76 }) {
+    auto fused = minColorDifferenceMatrix(views, metric);
+
+    std::vector<SymmetricMatrix<float>> separate;
+    for (const auto& view : views) {
+      separate.push_back(symmetricColorDifferenceMatrix(view, metric));
+    }
+
+    for (std::size_t i = 0; i < hsl_colors.size(); ++i) {
+      for (std::size_t j = 0; j < hsl_colors.size(); ++j) {
+        float expected = std::min(
+          { separate[0](i, j), separate[1](i, j), separate[2](i, j) });
+        REQUIRE(fused(i, j) == expected);
+      }
+    }
+  }
+
+  views[2].pop_back();
+  REQUIRE_THROWS_AS(
+    minColorDifferenceMatrix(views, metrics::MetricType::CIEDE2000),
+    std::invalid_argument);
+}
+
+TEST_CASE("Batched colors give the same matrices as color vectors",
+          "[colordiff]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+  using namespace Catch::Matchers;
+
+  std::vector<RGB> rgbs;
+  for (const auto& hsl : colorGrid<HSL>({ 0, 360 }, { 0, 1 }, { 0, 1 }, 60)) {
+    rgbs.emplace_back(hsl);
+  }
+
+  LabBatch labs(rgbs);
+  DIN99dBatch din99ds(rgbs);
+
+  REQUIRE(labs.size() == rgbs.size());
+  REQUIRE(reinterpret_cast<std::uintptr_t>(labs.l()) % 64 == 0);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(din99ds.b()) % 64 == 0);
+
+  for (std::size_t i = 0; i < rgbs.size(); ++i) {
+    Lab lab(rgbs[i]);
+    REQUIRE_THAT(labs[i].l(), WithinAbs(lab.l(), 1e-12));
+    REQUIRE_THAT(labs[i].a(), WithinAbs(lab.a(), 1e-12));
+    REQUIRE_THAT(labs[i].b(), WithinAbs(lab.b(), 1e-12));
+  }
+
+  auto ciede_batch = colorDifferenceMatrix(labs, metrics::CIEDE2000{});
+  auto ciede = colorDifferenceMatrix(rgbs, metrics::CIEDE2000{});
+  auto din99d_batch = colorDifferenceMatrix(din99ds, metrics::DIN99d{});
+  auto din99d = colorDifferenceMatrix(rgbs, metrics::DIN99d{});
+  auto packed = symmetricColorDifferenceMatrix(labs, metrics::CIE76{});
+  auto cie76 = colorDifferenceMatrix(rgbs, metrics::CIE76{});
+
+  for (std::size_t i = 0; i < rgbs.size(); ++i) {
+    for (std::size_t j = 0; j < rgbs.size(); ++j) {
+      REQUIRE_THAT(ciede_batch(i, j), WithinAbs(ciede(i, j), 1e-10));
+      REQUIRE_THAT(din99d_batch(i, j), WithinAbs(din99d(i, j), 1e-10));
+      REQUIRE_THAT(packed(i, j), WithinAbs(cie76(i, j), 1e-4));
+    }
+  }
+
+  // The DIN99d and CIE76 kernels do the same arithmetic as the functors.
+  std::vector<double> din99d_row(rgbs.size());
+  std::vector<double> cie76_row(rgbs.size());
+  for (std::size_t i = 0; i < rgbs.size(); i += 7) {
+    metrics::DIN99d{}.batch(din99ds[i],
+                            din99ds.l(),
+                            din99ds.a(),
+                            din99ds.b(),
+                            din99ds.size(),
+                            din99d_row.data());
+    metrics::CIE76{}.batch(
+      labs[i], labs.l(), labs.a(), labs.b(), labs.size(), cie76_row.data());
+    for (std::size_t j = 0; j < rgbs.size(); ++j) {
+      REQUIRE(din99d_row[j] == metrics::DIN99d{}(din99ds[j], din99ds[i]));
+      REQUIRE(cie76_row[j] == metrics::CIE76{}(labs[j], labs[i]));
+    }
+  }
+}
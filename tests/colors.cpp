@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <qualpal/color_batch.h>
 #include <qualpal/colors.h>
 
 TEST_CASE("All color conversions are supported", "[colors]")
@@ -487,3 +488,65 @@ TEST_CASE("Braced initializer lists for color construction", "[colors]")
   REQUIRE(base.size() == 3);
   REQUIRE(colors.size() == 3);
 }
+
+TEST_CASE("Batched conversions match single color conversions",
+          "[colors][batch]")
+{
+  using namespace Catch::Matchers;
+  using namespace qualpal::colors;
+
+  // Every 8-bit value per channel, plus components off the 8-bit grid
+  std::vector<RGB> rgbs;
+  for (int k = 0; k < 256; ++k) {
+    rgbs.emplace_back(k / 255.0, (255 - k) / 255.0, (k * 7 % 256) / 255.0);
+    rgbs.emplace_back(k / 256.0, (k * 13 % 256) / 256.0, 1.0 - k / 256.0);
+  }
+  rgbs.emplace_back("#000000");
+  rgbs.emplace_back("#ffffff");
+  rgbs.emplace_back("#010101");
+
+  auto xyzs = toXYZ(rgbs);
+  REQUIRE(xyzs.size() == rgbs.size());
+  for (std::size_t i = 0; i < rgbs.size(); ++i) {
+    XYZ xyz(rgbs[i]);
+    REQUIRE(xyzs[i].x() == xyz.x());
+    REQUIRE(xyzs[i].y() == xyz.y());
+    REQUIRE(xyzs[i].z() == xyz.z());
+  }
+
+  for (const auto& wp : { std::array<double, 3>{ 0.95047, 1, 1.08883 },
+                          std::array<double, 3>{ 1.09850, 1, 0.35585 } }) {
+    LabBatch labs(rgbs, wp);
+    DIN99dBatch din99ds(xyzs, wp);
+
+    for (std::size_t i = 0; i < rgbs.size(); ++i) {
+      Lab lab(xyzs[i], wp);
+      REQUIRE_THAT(labs.l()[i], WithinAbs(lab.l(), 1e-12));
+      REQUIRE_THAT(labs.a()[i], WithinAbs(lab.a(), 1e-12));
+      REQUIRE_THAT(labs.b()[i], WithinAbs(lab.b(), 1e-12));
+
+      DIN99d din99d(xyzs[i], wp);
+      REQUIRE_THAT(din99ds.l()[i], WithinAbs(din99d.l(), 1e-12));
+      REQUIRE_THAT(din99ds.a()[i], WithinAbs(din99d.a(), 1e-12));
+      REQUIRE_THAT(din99ds.b()[i], WithinAbs(din99d.b(), 1e-12));
+    }
+
+    // Lab back to XYZ cubes by multiplication instead of std::pow(), which
+    // only changes the last few bits.
+    std::vector<double> x(labs.size()), y(labs.size()), z(labs.size());
+    qualpal::detail::labToXYZ(labs.l(),
+                              labs.a(),
+                              labs.b(),
+                              labs.size(),
+                              wp,
+                              x.data(),
+                              y.data(),
+                              z.data());
+    for (std::size_t i = 0; i < labs.size(); ++i) {
+      XYZ xyz(labs[i], wp);
+      REQUIRE_THAT(x[i], WithinULP(xyz.x(), 4));
+      REQUIRE_THAT(y[i], WithinULP(xyz.y(), 4));
+      REQUIRE_THAT(z[i], WithinULP(xyz.z(), 4));
+    }
+  }
+}
@@ -1,5 +1,8 @@
 #include "../src/qualpal/color_grid.h"
+#include "../src/qualpal/continuous_refinement.h"
 #include "../src/qualpal/cvd.h"
+#include "../src/qualpal/farthest_points.h"
+#include <algorithm>
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
@@ -448,6 +451,60 @@ TEST_CASE("Continuous refinement strictly improves palette quality",
     REQUIRE(minDeltaE2000(multi) >= minDeltaE2000(single) - 1e-9);
   }
 
+  SECTION("Bottleneck refinement does not lower min CIEDE2000")
+  {
+    auto generate = [](int n_starts) {
+      return Qualpal{}
+        .setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+        .setRefinementStrategy(RefinementStrategy::Bottleneck)
+        .setRefinementStarts(n_starts)
+        .generate(12);
+    };
+    auto baseline = generate(0);
+    auto single = generate(1);
+    auto multi = generate(4);
+    REQUIRE(single.size() == 12);
+    REQUIRE(minDeltaE2000(single) > minDeltaE2000(baseline));
+    REQUIRE(minDeltaE2000(multi) >= minDeltaE2000(single) - 1e-9);
+  }
+
+  SECTION("Pattern search does not lower min CIEDE2000")
+  {
+    auto generate = [](LocalSearch local_search, int n_starts) {
+      return Qualpal{}
+        .setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+        .setLocalSearch(local_search)
+        .setRefinementStarts(n_starts)
+        .generate(12);
+    };
+    auto baseline = generate(LocalSearch::Pattern, 0);
+    auto single = generate(LocalSearch::Pattern, 1);
+    auto multi = generate(LocalSearch::Pattern, 4);
+    REQUIRE(single.size() == 12);
+    REQUIRE(baseline == generate(LocalSearch::Cube, 0));
+    REQUIRE(minDeltaE2000(single) > minDeltaE2000(baseline));
+    REQUIRE(minDeltaE2000(multi) >= minDeltaE2000(single) - 1e-9);
+  }
+
+  SECTION("Abandoning random starts never loses the warm start")
+  {
+    auto generate = [](int n_starts, bool abandon) {
+      return Qualpal{}
+        .setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+        .setRefinementStarts(n_starts)
+        .setAbandonStarts(abandon)
+        .generate(8);
+    };
+    auto single = generate(1, false);
+    auto abandoned = generate(16, true);
+    auto exact = generate(16, false);
+    REQUIRE(abandoned.size() == 8);
+    REQUIRE(minDeltaE2000(abandoned) >= minDeltaE2000(single) - 1e-9);
+    // Without abandonment every start runs to completion, so the result can
+    // only be as good or better.
+    REQUIRE(minDeltaE2000(exact) >= minDeltaE2000(abandoned) - 1e-9);
+  }
+
   SECTION("setRefinementStarts rejects negative values")
   {
     REQUIRE_THROWS_AS(Qualpal{}.setRefinementStarts(-1),
@@ -843,3 +900,412 @@ TEST_CASE("CVD simulations are applied independently", "[cvd][qualpal]")
     }
   }
 }
+
+TEST_CASE("Matrix-free farthest points matches the dense matrix",
+          "[farthest-points]")
+{
+  using namespace qualpal;
+
+  auto hsl_colors =
+    colorGrid<colors::HSL>({ 0, 360 }, { 0.3, 0.8 }, { 0.4, 0.9 }, 300);
+
+  std::vector<colors::XYZ> xyz_colors;
+  xyz_colors.emplace_back(colors::RGB("#ff0000"));
+  for (const auto& hsl : hsl_colors) {
+    xyz_colors.emplace_back(hsl);
+  }
+  xyz_colors.emplace_back(colors::RGB("#ffffff"));
+
+  const std::array<double, 3> wp = { 0.95047, 1, 1.08883 };
+  const std::map<std::string, double> cvd = { { "deutan", 0.7 },
+                                              { "tritan", 0.3 } };
+
+  // 300^2 doubles need ~0.7 MB, so a 0.1 MB limit forces the matrix-free
+  // backend while the default limit uses the dense matrix.
+  const double tiny_memory = 0.1 / 1024;
+
+  for (auto metric : { metrics::MetricType::DIN99d,
+                       metrics::MetricType::CIEDE2000,
+                       metrics::MetricType::CIE76 }) {
+    auto dense = farthestPoints(8, xyz_colors, metric, true, 1, 1, wp, cvd);
+    auto matrix_free =
+      farthestPoints(8, xyz_colors, metric, true, 1, tiny_memory, wp, cvd);
+
+    REQUIRE(dense == matrix_free);
+  }
+}
+
+TEST_CASE("Candidate pools larger than the matrix memory limit",
+          "[farthest-points]")
+{
+  using namespace qualpal;
+
+  // A full 20000 x 20000 matrix would need ~3 GB.
+  auto result = Qualpal{}
+                  .setInputColorspace({ 0, 360 }, { 0.3, 0.8 }, { 0.4, 0.9 })
+                  .setColorspaceSize(20000)
+                  .setRefinementStarts(0)
+                  .setMemoryLimit(0.5)
+                  .generate(4);
+
+  REQUIRE(result.size() == 4);
+}
+
+TEST_CASE("Farthest points selection cannot be improved by a single swap",
+          "[farthest-points]")
+{
+  using namespace qualpal;
+
+  auto hsl_colors =
+    colorGrid<colors::HSL>({ 0, 360 }, { 0.3, 0.8 }, { 0.4, 0.9 }, 200);
+
+  std::vector<colors::XYZ> xyz_colors;
+  for (const auto& hsl : hsl_colors) {
+    xyz_colors.emplace_back(hsl);
+  }
+
+  const std::size_t n = 12;
+  auto ind = farthestPoints(n, xyz_colors, metrics::MetricType::DIN99d);
+  auto dist_mat =
+    colorDifferenceMatrix(xyz_colors, metrics::MetricType::DIN99d);
+
+  std::vector<bool> selected(xyz_colors.size(), false);
+  for (auto i : ind) {
+    selected[i] = true;
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    double current = std::numeric_limits<double>::max();
+    for (std::size_t j = 0; j < n; ++j) {
+      if (j != i) {
+        current = std::min(current, dist_mat(ind[i], ind[j]));
+      }
+    }
+
+    for (std::size_t k = 0; k < xyz_colors.size(); ++k) {
+      if (selected[k]) {
+        continue;
+      }
+      double candidate = std::numeric_limits<double>::max();
+      for (std::size_t j = 0; j < n; ++j) {
+        if (j != i) {
+          candidate = std::min(candidate, dist_mat(k, ind[j]));
+        }
+      }
+      REQUIRE(candidate <= current);
+    }
+  }
+}
+
+TEST_CASE("Farthest points selection does not depend on the thread count",
+          "[farthest-points]")
+{
+  using namespace qualpal;
+
+  auto hsl_colors =
+    colorGrid<colors::HSL>({ 0, 360 }, { 0.3, 0.8 }, { 0.4, 0.9 }, 500);
+
+  std::vector<colors::XYZ> xyz_colors;
+  for (const auto& hsl : hsl_colors) {
+    xyz_colors.emplace_back(hsl);
+  }
+  xyz_colors.emplace_back(colors::RGB("#000000"));
+
+  const std::size_t n_threads = Threads::get();
+
+  Threads::set(1);
+  auto serial = farthestPoints(
+    15, xyz_colors, metrics::MetricType::CIEDE2000, true, 0, 1e-4);
+
+  Threads::set(4);
+  auto parallel = farthestPoints(
+    15, xyz_colors, metrics::MetricType::CIEDE2000, true, 0, 1e-4);
+
+  Threads::set(n_threads);
+
+  REQUIRE(serial == parallel);
+}
+
+TEST_CASE("Multi-start refinement does not depend on the thread count",
+          "[refinement]")
+{
+  using namespace qualpal;
+
+  auto generate = [](std::uint64_t seed) {
+    auto palette = Qualpal{}
+                     .setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+                     .setCvd({ { "deutan", 0.7 } })
+                     .setRefinementStarts(12)
+                     .setSeed(seed)
+                     .generate(6);
+    std::vector<std::string> hex;
+    for (const auto& color : palette) {
+      hex.push_back(color.hex());
+    }
+    return hex;
+  };
+
+  const std::size_t n_threads = Threads::get();
+
+  Threads::set(1);
+  auto serial = generate(3);
+
+  Threads::set(4);
+  auto parallel = generate(3);
+  auto repeated = generate(3);
+
+  Threads::set(n_threads);
+
+  REQUIRE(serial == parallel);
+  REQUIRE(parallel == repeated);
+}
+
+namespace {
+
+// Refines a fixed spread of colors from the default HSL region.
+qualpal::RefinementResult
+refineFixedSeed(const std::vector<qualpal::CvdSimulator>& cvd)
+{
+  using namespace qualpal;
+
+  const std::array<double, 3> wp = { 0.95047, 1, 1.08883 };
+  const std::vector<ColorspaceRegion> regions = { ColorspaceRegion{
+    { 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 } } };
+
+  std::vector<colors::XYZ> seed;
+  auto grid =
+    colorGrid<colors::HSL>({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 }, 200);
+  for (std::size_t i = 0; i < grid.size(); i += 25) {
+    seed.emplace_back(colors::RGB(grid[i]));
+  }
+  return refinePalette(seed, 0, false, regions, ColorspaceType::HSL, wp, cvd);
+}
+
+// Smallest CIEDE2000 difference between two refined colors over normal
+// vision and every simulation, computed one pair at a time.
+double
+scalarScore(const std::vector<qualpal::colors::XYZ>& xyz,
+            const std::vector<qualpal::CvdSimulator>& cvd)
+{
+  using namespace qualpal;
+
+  const std::array<double, 3> wp = { 0.95047, 1, 1.08883 };
+  std::vector<std::vector<colors::Lab>> views(1 + cvd.size());
+  for (const auto& color : xyz) {
+    views[0].emplace_back(color, wp);
+    for (std::size_t v = 0; v < cvd.size(); ++v) {
+      colors::RGB sim = cvd[v].simulate(colors::RGB(color));
+      views[v + 1].emplace_back(colors::XYZ(sim), wp);
+    }
+  }
+
+  metrics::CIEDE2000 dE;
+  double m = std::numeric_limits<double>::max();
+  for (const auto& view : views) {
+    for (std::size_t i = 0; i < view.size(); ++i) {
+      for (std::size_t j = i + 1; j < view.size(); ++j) {
+        m = std::min(m, dE(view[i], view[j]));
+      }
+    }
+  }
+  return m;
+}
+
+} // namespace
+
+TEST_CASE("Batched refinement scan matches a serial scalar scan",
+          "[refinement]")
+{
+  using namespace qualpal;
+
+  const std::size_t n_threads = Threads::get();
+
+  Threads::set(1);
+  auto serial = refineFixedSeed({});
+
+  Threads::set(4);
+  auto parallel = refineFixedSeed({});
+
+  Threads::set(n_threads);
+
+  REQUIRE(serial.selected == parallel.selected);
+  REQUIRE(serial.score == parallel.score);
+  REQUIRE(serial.evaluations == parallel.evaluations);
+  REQUIRE(std::count(serial.moved.begin(), serial.moved.end(), true) > 0);
+
+  // The batched kernel scores the palette like the scalar metric does.
+  REQUIRE(serial.score ==
+          Catch::Approx(scalarScore(serial.selected, {})).epsilon(1e-9));
+}
+
+TEST_CASE("Inline refinement views match scalar CVD simulation",
+          "[refinement][cvd]")
+{
+  using namespace qualpal;
+
+  // Three CVD types fill every inline view slot.
+  const auto cvd =
+    cvdSimulators({ { "deutan", 1.0 }, { "protan", 0.6 }, { "tritan", 0.8 } });
+  REQUIRE(cvd.size() == 3);
+
+  const std::size_t n_threads = Threads::get();
+
+  Threads::set(1);
+  auto serial = refineFixedSeed(cvd);
+
+  Threads::set(4);
+  auto parallel = refineFixedSeed(cvd);
+
+  Threads::set(n_threads);
+
+  REQUIRE(serial.selected == parallel.selected);
+  REQUIRE(serial.score == parallel.score);
+  REQUIRE(serial.score ==
+          Catch::Approx(scalarScore(serial.selected, cvd)).epsilon(1e-9));
+  REQUIRE(serial.score < refineFixedSeed({}).score);
+}
+
+TEST_CASE("Repeated generate() calls reuse candidates correctly", "[core]")
+{
+  using namespace qualpal;
+
+  auto configure = [](Qualpal& qp) {
+    qp.setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+      .setColorspaceSize(400)
+      .setRefinementStarts(0);
+  };
+
+  auto fresh = [&](std::size_t n) {
+    Qualpal qp;
+    configure(qp);
+    return qp.generate(n);
+  };
+
+  Qualpal qp;
+  configure(qp);
+
+  REQUIRE(qp.generate(4) == fresh(4));
+  REQUIRE(qp.generate(9) == fresh(9));
+
+  auto base = fresh(3);
+  Qualpal reference;
+  configure(reference);
+  REQUIRE(qp.extend(base, 6) == reference.extend(base, 6));
+  REQUIRE(qp.generate(5) == fresh(5));
+
+  SECTION("Setters invalidate the kept candidates")
+  {
+    qp.setBackground(colors::RGB("#ffffff"));
+    Qualpal with_bg;
+    configure(with_bg);
+    with_bg.setBackground(colors::RGB("#ffffff"));
+    REQUIRE(qp.generate(5) == with_bg.generate(5));
+
+    qp.setInputHex({ "#ff0000", "#00ff00", "#0000ff", "#ffff00" });
+    REQUIRE(qp.generate(2) == Qualpal{}
+                                .setInputHex({ "#ff0000",
+                                               "#00ff00",
+                                               "#0000ff",
+                                               "#ffff00" })
+                                .setBackground(colors::RGB("#ffffff"))
+                                .generate(2));
+  }
+}
+
+TEST_CASE("generateSequence grows palettes one color at a time", "[core]")
+{
+  using namespace qualpal;
+
+  const std::vector<std::string> hex = { "#ff0000", "#00ff00", "#0000ff",
+                                         "#ffff00", "#00ffff", "#ff00ff" };
+  Qualpal qp;
+  qp.setInputHex(hex);
+
+  auto sequence = qp.generateSequence(hex.size());
+  REQUIRE(sequence.size() == hex.size());
+  for (std::size_t k = 0; k < sequence.size(); ++k) {
+    REQUIRE(sequence[k].size() == k + 1);
+    for (const auto& color : sequence[k]) {
+      REQUIRE(std::find(hex.begin(), hex.end(), color.hex()) != hex.end());
+    }
+  }
+
+  // The largest palette must use every input color exactly once.
+  std::vector<std::string> largest;
+  for (const auto& color : sequence.back()) {
+    largest.push_back(color.hex());
+  }
+  std::sort(largest.begin(), largest.end());
+  auto sorted_hex = hex;
+  std::sort(sorted_hex.begin(), sorted_hex.end());
+  REQUIRE(largest == sorted_hex);
+
+  // Every palette is a prefix of the next one.
+  auto isPrefix = [](const std::vector<colors::RGB>& shorter,
+                     const std::vector<colors::RGB>& longer) {
+    for (std::size_t i = 0; i < shorter.size(); ++i) {
+      if (shorter[i].r() != longer[i].r() || shorter[i].g() != longer[i].g() ||
+          shorter[i].b() != longer[i].b()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (std::size_t k = 1; k < sequence.size(); ++k) {
+    REQUIRE(isPrefix(sequence[k - 1], sequence[k]));
+  }
+
+  REQUIRE(qp.generate(3).size() == 3);
+  REQUIRE_THROWS_AS(qp.generateSequence(hex.size() + 1),
+                    std::invalid_argument);
+
+  SECTION("Colorspace input with refinement")
+  {
+    auto palettes =
+      Qualpal{}
+        .setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+        .setColorspaceSize(300)
+        .setRefinementStarts(3)
+        .generateSequence(6);
+    REQUIRE(palettes.size() == 6);
+    for (std::size_t k = 0; k < palettes.size(); ++k) {
+      REQUIRE(palettes[k].size() == k + 1);
+      if (k > 0) {
+        REQUIRE(isPrefix(palettes[k - 1], palettes[k]));
+      }
+    }
+  }
+
+  SECTION("Palettes are read from and written to the cache")
+  {
+    auto cache = std::make_shared<PaletteCache>(16);
+    auto configured = [&cache] {
+      Qualpal cached;
+      cached.setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+        .setColorspaceSize(300)
+        .setRefinementStarts(2)
+        .setCache(cache);
+      return cached;
+    };
+
+    auto first = configured().generateSequence(5);
+    REQUIRE(cache->misses() == 5);
+    REQUIRE(cache->size() == 5);
+
+    auto second = configured().generateSequence(5);
+    REQUIRE(cache->hits() == 5);
+    for (std::size_t k = 0; k < first.size(); ++k) {
+      REQUIRE(isPrefix(first[k], second[k]));
+    }
+
+    // Only the missing palettes are generated, from the cached ones.
+    auto longer = configured().generateSequence(6);
+    REQUIRE(cache->hits() == 10);
+    REQUIRE(cache->misses() == 6);
+    REQUIRE(isPrefix(first.back(), longer.back()));
+
+    // The sequence does not share entries with generate().
+    configured().generate(5);
+    REQUIRE(cache->misses() == 7);
+  }
+}
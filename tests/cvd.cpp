@@ -1,7 +1,12 @@
 #include "../src/qualpal/cvd.h"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <map>
+#include <qualpal/color_batch.h>
 #include <qualpal/colors.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 TEST_CASE("CVD simulation basic functionality", "[cvd]")
 {
@@ -148,6 +153,110 @@ TEST_CASE("CVD simulation type validation", "[cvd]")
     REQUIRE(deutan_result.r() != tritan_result.r());
     REQUIRE(protan_result.r() != tritan_result.r());
   }
+
+  SECTION("Invalid CVD types and severities throw")
+  {
+    REQUIRE_THROWS_AS(CvdSimulator("achromat", 0.5), std::invalid_argument);
+    REQUIRE_THROWS_AS(CvdSimulator("protan", 1.5), std::invalid_argument);
+    REQUIRE_THROWS_AS(CvdSimulator("protan", -0.1), std::invalid_argument);
+  }
+}
+
+TEST_CASE("CVD simulator matches per-color simulation", "[cvd]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+
+  std::vector<RGB> colors;
+  for (int i = 0; i < 64; ++i) {
+    colors.emplace_back(i / 63.0, (i * 5 % 64) / 63.0, (i * 11 % 64) / 63.0);
+  }
+
+  std::vector<double> r, g, b;
+  for (const auto& color : colors) {
+    r.push_back(color.r());
+    g.push_back(color.g());
+    b.push_back(color.b());
+  }
+
+  auto simulators =
+    cvdSimulators({ { "protan", 0.35 }, { "deutan", 0.0 }, { "tritan", 1.0 } });
+  REQUIRE(simulators.size() == 2);
+
+  for (const auto& [type, severity] :
+       std::map<std::string, double>{ { "protan", 0.35 },
+                                      { "deutan", 0.8 },
+                                      { "tritan", 1.0 } }) {
+    CvdSimulator simulator(type, severity);
+    auto batch = simulator.simulate(colors);
+
+    std::vector<double> r_out(colors.size()), g_out(colors.size()),
+      b_out(colors.size());
+    simulator.simulate(r.data(),
+                       g.data(),
+                       b.data(),
+                       colors.size(),
+                       r_out.data(),
+                       g_out.data(),
+                       b_out.data());
+
+    for (std::size_t i = 0; i < colors.size(); ++i) {
+      RGB expected = simulateCvd(colors[i], type, severity);
+      REQUIRE(batch[i].r() == expected.r());
+      REQUIRE(batch[i].g() == expected.g());
+      REQUIRE(batch[i].b() == expected.b());
+      REQUIRE(r_out[i] == expected.r());
+      REQUIRE(g_out[i] == expected.g());
+      REQUIRE(b_out[i] == expected.b());
+    }
+  }
+}
+
+TEST_CASE("Fused CVD simulation to XYZ matches per-color conversion", "[cvd]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+  using namespace Catch::Matchers;
+
+  std::vector<double> x, y, z;
+  for (int i = 0; i < 50; ++i) {
+    const double a = (i * 7 % 50) * 4.0 - 100.0;
+    const double b = (i * 13 % 50) * 4.0 - 100.0;
+    XYZ xyz(Lab(i * 2.0, a, b));
+    x.push_back(xyz.x());
+    y.push_back(xyz.y());
+    z.push_back(xyz.z());
+  }
+  const std::size_t n = x.size();
+
+  std::vector<double> r(n), g(n), b(n);
+  detail::xyzToRGB(
+    x.data(), y.data(), z.data(), n, r.data(), g.data(), b.data());
+  for (std::size_t i = 0; i < n; ++i) {
+    RGB expected(XYZ(x[i], y[i], z[i]));
+    REQUIRE_THAT(r[i], WithinAbs(expected.r(), 1e-12));
+    REQUIRE_THAT(g[i], WithinAbs(expected.g(), 1e-12));
+    REQUIRE_THAT(b[i], WithinAbs(expected.b(), 1e-12));
+  }
+
+  for (const auto& simulator : cvdSimulators(
+         { { "protan", 0.35 }, { "deutan", 0.8 }, { "tritan", 1.0 } })) {
+    std::vector<double> x_out(n), y_out(n), z_out(n);
+    simulator.simulateToXYZ(r.data(),
+                            g.data(),
+                            b.data(),
+                            n,
+                            x_out.data(),
+                            y_out.data(),
+                            z_out.data());
+
+    for (std::size_t i = 0; i < n; ++i) {
+      XYZ expected(simulator.simulate(RGB(r[i], g[i], b[i])));
+      REQUIRE_THAT(x_out[i], WithinAbs(expected.x(), 1e-12));
+      REQUIRE_THAT(y_out[i], WithinAbs(expected.y(), 1e-12));
+      REQUIRE_THAT(z_out[i], WithinAbs(expected.z(), 1e-12));
+    }
+  }
 }
 
 TEST_CASE("CVD simulation mathematical properties", "[cvd]")
@@ -67,6 +67,38 @@ TEST_CASE("Dynamic Matrix transpose", "[matrix][dynamic]")
   REQUIRE_THAT(transposed(2, 1), WithinAbs(6.0, 1e-10));
 }
 
+TEST_CASE("SymmetricMatrix shares mirrored elements", "[matrix][symmetric]")
+{
+  SymmetricMatrix<float> mat(3);
+
+  REQUIRE(mat.nrow() == 3);
+  REQUIRE(mat.ncol() == 3);
+
+  for (std::size_t i = 0; i < 3; ++i) {
+    for (std::size_t j = 0; j < 3; ++j) {
+      REQUIRE(mat(i, j) == 0.0f);
+    }
+  }
+
+  mat(0, 2) = 1.5f;
+  mat(2, 1) = 2.5f;
+  mat(1, 1) = 3.0f;
+
+  REQUIRE(mat(2, 0) == 1.5f);
+  REQUIRE(mat(1, 2) == 2.5f);
+  REQUIRE(mat(1, 1) == 3.0f);
+
+  Matrix<double> full = mat.toMatrix<double>();
+  REQUIRE(full.nrow() == 3);
+  REQUIRE(full.ncol() == 3);
+  for (std::size_t i = 0; i < 3; ++i) {
+    for (std::size_t j = 0; j < 3; ++j) {
+      REQUIRE_THAT(full(i, j), WithinAbs(mat(i, j), 1e-10));
+      REQUIRE_THAT(full(i, j), WithinAbs(full(j, i), 1e-10));
+    }
+  }
+}
+
 TEST_CASE("FixedMatrix construction", "[matrix][fixed]")
 {
   SECTION("Default construction")
@@ -1,3 +1,5 @@
+#include "../src/qualpal/color_grid.h"
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <qualpal/colors.h>
@@ -101,3 +103,97 @@ TEST_CASE("CIE76 metric", "[metrics][cie76]")
     REQUIRE_THAT(diff, WithinAbs(50.019996, 1e-5));
   }
 }
+
+TEST_CASE("CIEDE2000 batch kernel matches the scalar metric",
+          "[metrics][ciede2000]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+  using namespace Catch::Matchers;
+
+  // Colors spread over Lab space, plus achromatic colors and hues on the a
+  // and b axes. Exactly complementary hues are avoided: CIEDE2000 is
+  // discontinuous there, so the result depends on the last bit of the hue
+  // angles.
+  std::vector<Lab> labs;
+  for (const auto& lch :
+       colorGrid<LCHab>({ 0, 350 }, { 0, 100 }, { 0, 100 }, 300)) {
+    labs.emplace_back(lch);
+  }
+  labs.emplace_back(0, 0, 0);
+  labs.emplace_back(50, 0, 0);
+  labs.emplace_back(100, 0, 0);
+  labs.emplace_back(60, 0, 30);
+  labs.emplace_back(40, 0, -30);
+  labs.emplace_back(70, 40, 0);
+  labs.emplace_back(30, -40, 0);
+
+  std::vector<double> ls, as, bs;
+  for (const auto& lab : labs) {
+    ls.push_back(lab.l());
+    as.push_back(lab.a());
+    bs.push_back(lab.b());
+  }
+
+  for (auto met : { metrics::CIEDE2000{}, metrics::CIEDE2000(2, 1, 1) }) {
+    std::vector<double> out(labs.size());
+
+    for (std::size_t i = 0; i < labs.size(); i += 7) {
+      met.batch(
+        labs[i], ls.data(), as.data(), bs.data(), labs.size(), out.data());
+
+      for (std::size_t j = 0; j < labs.size(); ++j) {
+        REQUIRE_THAT(out[j], WithinAbs(met(labs[i], labs[j]), 1e-6));
+
+        double reversed;
+        met.batch(labs[j], &ls[i], &as[i], &bs[i], 1, &reversed);
+        REQUIRE(reversed == out[j]);
+      }
+    }
+  }
+}
+
+TEST_CASE("CIEDE2000 lower bounds never exceed the difference",
+          "[metrics][ciede2000]")
+{
+  using namespace qualpal;
+  using namespace qualpal::colors;
+
+  // Colors over the whole Lab box, including ones outside sRGB and exactly
+  // complementary pairs, where the bound must hold for either branch of the
+  // formula.
+  std::vector<Lab> labs;
+  for (const auto& lab :
+       colorGrid<LCHab>({ 0, 360 }, { 0, 180 }, { 0, 100 }, 400)) {
+    labs.emplace_back(lab);
+  }
+  labs.emplace_back(50, 40, 0);
+  labs.emplace_back(50, -40, 0);
+  labs.emplace_back(30, 0, -60);
+  labs.emplace_back(70, 0, 60);
+  labs.emplace_back(50, 0, 0);
+
+  const LabBatch batch(labs);
+  std::vector<double> bound(labs.size());
+  std::vector<double> exact(labs.size());
+
+  for (auto met : { metrics::CIEDE2000{},
+                    metrics::CIEDE2000(2, 1, 1),
+                    metrics::CIEDE2000(1, 0.5, 3) }) {
+    double tightest = 0.0;
+    for (std::size_t i = 0; i < labs.size(); ++i) {
+      met.lowerBound(labs[i], batch, bound.data());
+      met.batch(labs[i], batch, exact.data());
+
+      for (std::size_t j = 0; j < labs.size(); ++j) {
+        REQUIRE(bound[j] >= 0.0);
+        REQUIRE(bound[j] <= exact[j]);
+        if (exact[j] > 0.0) {
+          tightest = std::max(tightest, bound[j] / exact[j]);
+        }
+      }
+    }
+    // Pairs that differ mostly in lightness get close bounds.
+    REQUIRE(tightest > 0.5);
+  }
+}
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <memory>
+#include <qualpal.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace qualpal;
+
+namespace {
+
+bool
+samePalette(const std::vector<colors::RGB>& x,
+            const std::vector<colors::RGB>& y)
+{
+  if (x.size() != y.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    if (x[i].r() != y[i].r() || x[i].g() != y[i].g() || x[i].b() != y[i].b()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+PaletteKey
+keyOf(const std::string& name)
+{
+  return PaletteKeyBuilder().addString(name).key();
+}
+
+Qualpal
+configured()
+{
+  Qualpal qp;
+  qp.setInputColorspace({ 0, 360 }, { 0.4, 1.0 }, { 0.3, 0.85 })
+    .setColorspaceSize(300)
+    .setRefinementStarts(2);
+  return qp;
+}
+
+} // namespace
+
+TEST_CASE("Palette cache returns identical palettes", "[cache]")
+{
+  auto cache = std::make_shared<PaletteCache>(8);
+
+  auto uncached = configured().generate(5);
+
+  auto qp = configured();
+  qp.setCache(cache);
+  auto first = qp.generate(5);
+  auto second = qp.generate(5);
+
+  REQUIRE(cache->misses() == 1);
+  REQUIRE(cache->hits() == 1);
+  REQUIRE(cache->size() == 1);
+  REQUIRE(samePalette(first, uncached));
+  REQUIRE(samePalette(second, uncached));
+
+  SECTION("Other Qualpal objects share the cache")
+  {
+    auto other = configured();
+    other.setCache(cache);
+    REQUIRE(samePalette(other.generate(5), uncached));
+    REQUIRE(cache->hits() == 2);
+  }
+
+  SECTION("Any change in the configuration is a miss")
+  {
+    qp.generate(6);
+    qp.setSeed(1).generate(5);
+    qp.setSeed(0).setBackground(colors::RGB("#ffffff")).generate(5);
+    qp.extend({ colors::RGB("#ff0000") }, 5);
+    REQUIRE(cache->hits() == 1);
+    REQUIRE(cache->misses() == 5);
+  }
+
+  SECTION("Equal input colors share a key however they are written")
+  {
+    auto hex = [&](const std::vector<std::string>& colors) {
+      Qualpal other;
+      other.setInputHex(colors).setCache(cache);
+      return other.generate(2);
+    };
+    auto short_form = hex({ "#FFF", "#000", "#f00" });
+    auto long_form = hex({ "#ffffff", "#000000", "#FF0000" });
+    Qualpal rgb;
+    rgb
+      .setInputRGB({ colors::RGB(1.0, 1.0, 1.0),
+                     colors::RGB(0.0, 0.0, 0.0),
+                     colors::RGB(1.0, 0.0, 0.0) })
+      .setCache(cache);
+    auto from_rgb = rgb.generate(2);
+
+    REQUIRE(cache->misses() == 2);
+    REQUIRE(cache->hits() == 3);
+    REQUIRE(samePalette(long_form, short_form));
+    REQUIRE(samePalette(from_rgb, short_form));
+  }
+
+  SECTION("Clearing resets the cache")
+  {
+    cache->clear();
+    REQUIRE(cache->size() == 0);
+    REQUIRE(cache->hits() == 0);
+    REQUIRE(cache->misses() == 0);
+  }
+}
+
+TEST_CASE("Palette cache evicts the least recently used palette", "[cache]")
+{
+  PaletteCache cache(2);
+  const std::vector<colors::RGB> red = { colors::RGB("#ff0000") };
+  const std::vector<colors::RGB> green = { colors::RGB("#00ff00") };
+  const std::vector<colors::RGB> blue = { colors::RGB("#0000ff") };
+
+  cache.insert(keyOf("red"), red);
+  cache.insert(keyOf("green"), green);
+  REQUIRE(cache.find(keyOf("red")));
+  cache.insert(keyOf("blue"), blue);
+
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.find(keyOf("red")));
+  REQUIRE(cache.find(keyOf("blue")));
+  REQUIRE_FALSE(cache.find(keyOf("green")));
+  REQUIRE(cache.hits() == 3);
+  REQUIRE(cache.misses() == 1);
+
+  REQUIRE_THROWS_AS(PaletteCache(0), std::invalid_argument);
+}
+
+TEST_CASE("Palette cache keys have a fixed width", "[cache]")
+{
+  const PaletteKey key = keyOf("red");
+  REQUIRE(key.digest().size() == 32);
+  REQUIRE(keyOf(std::string(10000, 'x')).digest().size() == 32);
+
+  REQUIRE(keyOf("red").digest() == key.digest());
+  REQUIRE(keyOf("green").digest() != key.digest());
+  REQUIRE(PaletteKeyBuilder().addNumber(0.0).key().digest() !=
+          PaletteKeyBuilder().addNumber(-0.0).key().digest());
+  REQUIRE(PaletteKeyBuilder().addString("ab").addString("c").key().digest() !=
+          PaletteKeyBuilder().addString("a").addString("bc").key().digest());
+
+  // A palette under the same digest but another fingerprint is not returned.
+  PaletteCache cache(2);
+  cache.insert(key, { colors::RGB("#ff0000") });
+  PaletteKey collision = key;
+  collision.fingerprint ^= 1;
+  REQUIRE_FALSE(cache.find(collision));
+  REQUIRE(cache.find(key));
+}
+
+TEST_CASE("Palette cache persists palettes on disk", "[cache]")
+{
+  const auto directory =
+    std::filesystem::temp_directory_path() / "qualpal_palette_cache_test";
+  std::filesystem::remove_all(directory);
+
+  std::vector<colors::RGB> palette;
+  {
+    auto cache = std::make_shared<PaletteCache>(4, directory.string());
+    auto qp = configured();
+    qp.setCache(cache);
+    palette = qp.generate(4);
+  }
+
+  auto cache = std::make_shared<PaletteCache>(4, directory.string());
+  auto qp = configured();
+  qp.setCache(cache);
+  auto restored = qp.generate(4);
+
+  REQUIRE(cache->hits() == 1);
+  REQUIRE(cache->misses() == 0);
+  REQUIRE(samePalette(restored, palette));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Concurrent writers of one key leave a complete file", "[cache]")
+{
+  const auto directory =
+    std::filesystem::temp_directory_path() / "qualpal_palette_cache_race";
+  std::filesystem::remove_all(directory);
+
+  std::vector<std::vector<colors::RGB>> palettes;
+  for (int t = 0; t < 4; ++t) {
+    palettes.push_back(std::vector<colors::RGB>(
+      16, colors::RGB(0.1 * t, 0.2, 1.0 - 0.1 * t)));
+  }
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([&, t] {
+      PaletteCache cache(4, directory.string());
+      for (int k = 0; k < 25; ++k) {
+        cache.insert(keyOf("key"), palettes[t]);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  std::size_t n_files = 0;
+  for (const auto& file : std::filesystem::directory_iterator(directory)) {
+    REQUIRE(file.path().extension() == ".pal");
+    REQUIRE(file.path().stem().string() == keyOf("key").digest());
+    ++n_files;
+  }
+  REQUIRE(n_files == 1);
+
+  PaletteCache cache(4, directory.string());
+  auto restored = cache.find(keyOf("key"));
+  REQUIRE(restored);
+  REQUIRE(std::any_of(palettes.begin(), palettes.end(), [&](const auto& p) {
+    return samePalette(p, *restored);
+  }));
+
+  std::filesystem::remove_all(directory);
+}
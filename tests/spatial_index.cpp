@@ -0,0 +1,55 @@
+#include "../src/qualpal/color_grid.h"
+#include "../src/qualpal/spatial_index.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <qualpal/color_batch.h>
+#include <vector>
+
+using namespace qualpal;
+
+namespace {
+
+colors::LabBatch
+candidateLabs(std::size_t n)
+{
+  std::vector<colors::RGB> rgbs;
+  for (const auto& hsl :
+       colorGrid<colors::HSL>({ 0, 360 }, { 0, 1 }, { 0, 1 }, n)) {
+    rgbs.emplace_back(hsl);
+  }
+  return colors::LabBatch(rgbs);
+}
+
+} // namespace
+
+TEST_CASE("LabGrid holds every point exactly once", "[spatial_index]")
+{
+  const auto labs = candidateLabs(5000);
+  const LabGrid grid(labs.l(), labs.a(), labs.b(), labs.size(), 16);
+
+  REQUIRE(grid.size() == labs.size());
+  REQUIRE(grid.cellCount() > 1);
+
+  std::vector<int> seen(labs.size(), 0);
+  for (std::size_t c = 0; c < grid.cellCount(); ++c) {
+    const auto cell = grid.cell(c);
+    REQUIRE(std::is_sorted(cell.begin(), cell.end()));
+    for (std::size_t i : cell) {
+      REQUIRE(grid.cellOf(i) == c);
+      ++seen[i];
+    }
+  }
+  REQUIRE(std::all_of(seen.begin(), seen.end(), [](int k) { return k == 1; }));
+}
+
+TEST_CASE("LabGrid handles degenerate inputs", "[spatial_index]")
+{
+  const LabGrid empty(nullptr, nullptr, nullptr, 0);
+  REQUIRE(empty.size() == 0);
+
+  // All points equal
+  const std::vector<double> l(10, 50.0), a(10, 1.0), b(10, -1.0);
+  const LabGrid same(l.data(), a.data(), b.data(), l.size());
+  REQUIRE(same.cellCount() == 1);
+  REQUIRE(same.cell(0).size() == 10);
+}
@@ -1,6 +1,11 @@
+#include "../src/qualpal/palettes.h"
 #include "../src/qualpal/validation.h"
+#include <array>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace qualpal;
 
@@ -33,6 +38,118 @@ TEST_CASE("isValidHexColor validates correctly", "[validation]")
   }
 }
 
+TEST_CASE("parseHexColor parses and locates errors", "[validation]")
+{
+  std::array<unsigned char, 3> rgb;
+
+  SECTION("Valid hex colors")
+  {
+    REQUIRE_FALSE(parseHexColor("#ff8000", rgb));
+    REQUIRE(rgb == std::array<unsigned char, 3>{ 255, 128, 0 });
+
+    REQUIRE_FALSE(parseHexColor("#A1b2C3", rgb));
+    REQUIRE(rgb == std::array<unsigned char, 3>{ 0xa1, 0xb2, 0xc3 });
+
+    REQUIRE_FALSE(parseHexColor("#f80", rgb));
+    REQUIRE(rgb == std::array<unsigned char, 3>{ 255, 136, 0 });
+  }
+
+  SECTION("Error positions")
+  {
+    REQUIRE(parseHexColor("", rgb)->position == 0);
+    REQUIRE(parseHexColor("ff0000", rgb)->position == 0);
+    REQUIRE(parseHexColor("#gg0000", rgb)->position == 1);
+    REQUIRE(parseHexColor("#ff 000", rgb)->position == 3);
+    REQUIRE(parseHexColor("#ff000z", rgb)->position == 6);
+    REQUIRE(parseHexColor("#ff00", rgb)->position == 5);
+    REQUIRE(parseHexColor("#ff000000", rgb)->position == 7);
+    REQUIRE(parseHexColor("#", rgb)->position == 1);
+    REQUIRE(parseHexColor(std::string("#ff") + '\0' + "000", rgb)->position ==
+            3);
+
+    const auto error = parseHexColor("#ff-000", rgb);
+    REQUIRE(error);
+    REQUIRE(error->reason.find("'-' at position 3") != std::string::npos);
+  }
+
+  SECTION("Agrees with RGB(const std::string&)")
+  {
+    for (const std::string hex : { "#000000", "#ffffff", "#123abc", "#9f0" }) {
+      REQUIRE_FALSE(parseHexColor(hex, rgb));
+      const colors::RGB color(hex);
+      REQUIRE(color.r() == rgb[0] / 255.0);
+      REQUIRE(color.g() == rgb[1] / 255.0);
+      REQUIRE(color.b() == rgb[2] / 255.0);
+    }
+    REQUIRE_THROWS_AS(colors::RGB("#12345"), std::invalid_argument);
+  }
+}
+
+TEST_CASE("parseHexColors handles large inputs", "[validation]")
+{
+  const std::size_t n = 1000000;
+  std::vector<std::string> hex;
+  hex.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    hex.push_back(colors::RGB((i % 256) / 255.0,
+                              ((i / 256) % 256) / 255.0,
+                              ((i / 65536) % 256) / 255.0)
+                    .hex());
+  }
+
+  const auto rgb = parseHexColors(hex);
+  REQUIRE(rgb.size() == n);
+  for (std::size_t i = 0; i < n; i += 997) {
+    REQUIRE(rgb[i].hex() == hex[i]);
+  }
+
+  // The error names the offending color and character.
+  hex[n - 2] = "#12345g";
+  try {
+    parseHexColors(hex);
+    FAIL("Expected an exception");
+  } catch (const std::invalid_argument& e) {
+    const std::string message = e.what();
+    REQUIRE(message.find("'#12345g' at index 999998") != std::string::npos);
+    REQUIRE(message.find("'g' at position 6") != std::string::npos);
+  }
+}
+
+TEST_CASE("Built-in palettes are found by name", "[validation]")
+{
+  // The table is usable in constant expressions.
+  static_assert(BuiltinPalette::hexValue('f') == 15);
+  static_assert(BUILTIN_PALETTES[0].size() > 0);
+
+  std::size_t n_palettes = 0;
+  for (const auto& pal : BUILTIN_PALETTES) {
+    const std::string name =
+      std::string(pal.package) + ":" + std::string(pal.name);
+    REQUIRE(&findPalette(name) == &pal);
+
+    const auto hex = getPalette(name);
+    REQUIRE(hex.size() == pal.size());
+    for (std::size_t i = 0; i < pal.size(); ++i) {
+      std::array<unsigned char, 3> rgb;
+      REQUIRE_FALSE(parseHexColor(hex[i], rgb));
+      REQUIRE(rgb == pal.rgb(i));
+    }
+    ++n_palettes;
+  }
+
+  std::size_t n_listed = 0;
+  for (const auto& pkg : listAvailablePalettes()) {
+    n_listed += pkg.second.size();
+  }
+  REQUIRE(n_listed == n_palettes);
+
+  REQUIRE_THROWS_AS(findPalette("ColorBrewer"), std::invalid_argument);
+  REQUIRE_THROWS_AS(findPalette("ColorBrewer:"), std::invalid_argument);
+  REQUIRE_THROWS_AS(findPalette("ColorBrewer:Set9"), std::invalid_argument);
+  REQUIRE_THROWS_AS(findPalette("colorbrewer:Set2"), std::invalid_argument);
+  REQUIRE_THROWS_AS(findPalette(":Set2"), std::invalid_argument);
+}
+
 TEST_CASE("validateHslRanges validates correctly", "[validation]")
 {
   SECTION("Valid ranges")
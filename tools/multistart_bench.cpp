@@ -3,7 +3,9 @@
 // Compares discrete-only, single-start refinement (the current default),
 // and multi-start refinement (production refinement run from seed 0 plus
 // M random-start refinements, take the best). Reports the bound from a
-// matched-cost aggressive multi-start as a quality ceiling.
+// matched-cost aggressive multi-start as a quality ceiling. Every refined
+// strategy is run with each local search, and the number of candidate
+// evaluations is reported next to the quality.
 //
 // Build: cmake -B build -S . -DBUILD_TUNING=ON && cmake --build build
 // Run:   ./build/tools/multistart_bench > multistart.csv
@@ -42,6 +44,24 @@ const std::vector<Cfg> CFGS = {
   { "narrow_s", { 0, 360 }, { 0.7, 0.71 }, { 0.3, 0.7 } },
 };
 
+struct LocalSearchCfg
+{
+  const char* name;
+  LocalSearch search;
+};
+
+const std::vector<LocalSearchCfg> SEARCHES = {
+  { "cube", LocalSearch::Cube },
+  { "pattern", LocalSearch::Pattern },
+};
+
+// A palette together with the candidate evaluations spent refining it.
+struct Run
+{
+  std::vector<colors::RGB> palette;
+  std::size_t evaluations = 0;
+};
+
 double
 minDeltaE(const std::vector<colors::RGB>& pal)
 {
@@ -116,60 +136,80 @@ regionsFor(const Cfg& cfg)
   return { ColorspaceRegion{ cfg.h, cfg.s, cfg.l } };
 }
 
-// Run the standard production pipeline (discrete farthestPoints + refine).
+// Run the discrete stage of the production pipeline (farthestPoints only).
 std::vector<colors::RGB>
-standardPipeline(const Cfg& cfg, size_t n_points, size_t k, bool refine)
+discretePipeline(const Cfg& cfg, size_t n_points, size_t k)
 {
   Qualpal qp;
   qp.setInputColorspace(cfg.h, cfg.s, cfg.l)
     .setColorspaceSize(n_points)
     .setMetric(metrics::MetricType::CIEDE2000)
-    .setRefinementStarts(refine ? 1 : 0)
+    .setRefinementStarts(0)
     .setMemoryLimit(32.0);
   return qp.generate(k);
 }
 
-// Random start + production refinement.
-std::vector<colors::RGB>
-randomThenRefine(std::mt19937& rng, const Cfg& cfg, size_t k)
+// Production refinement of the given seed colors. refinePalette() is called
+// directly, rather than through Qualpal, to get at the evaluation count.
+Run
+refine(std::vector<colors::XYZ> seed_xyz, const Cfg& cfg, LocalSearch search)
 {
-  auto seed_xyz = randomStartXYZ(rng, cfg, k);
   auto refined = refinePalette(std::move(seed_xyz),
                                0,
                                false,
                                regionsFor(cfg),
                                ColorspaceType::HSL,
                                WP_D65,
-                               {});
-  std::vector<colors::RGB> out;
-  out.reserve(k);
+                               {},
+                               -std::numeric_limits<double>::infinity(),
+                               RefinementStrategy::Sweep,
+                               search);
+  Run out;
+  out.evaluations = refined.evaluations;
+  out.palette.reserve(refined.selected.size());
   for (auto& xyz : refined.selected)
-    out.emplace_back(xyz);
+    out.palette.emplace_back(xyz);
   return out;
 }
 
-double
+// Discrete farthestPoints + refinement, as in the default pipeline.
+Run
+singleStart(const Cfg& cfg, size_t n_points, size_t k, LocalSearch search)
+{
+  std::vector<colors::XYZ> seed_xyz;
+  for (const auto& rgb : discretePipeline(cfg, n_points, k))
+    seed_xyz.emplace_back(rgb);
+  return refine(std::move(seed_xyz), cfg, search);
+}
+
+Run
 runMultistart(const Cfg& cfg,
               size_t n_points,
               size_t k,
               size_t n_extra_starts,
-              uint64_t seed)
+              uint64_t seed,
+              LocalSearch search)
 {
   // Seed 0: production pipeline (warm start from discrete farthestPoints).
-  auto pal0 = standardPipeline(cfg, n_points, k, true);
-  double best = minDeltaE(pal0);
+  Run best = singleStart(cfg, n_points, k, search);
+  double best_de = minDeltaE(best.palette);
 
-  std::vector<double> per_start(n_extra_starts, 0.0);
+  std::vector<Run> per_start(n_extra_starts);
 #ifdef _OPENMP
 #pragma omp parallel for schedule(dynamic)
 #endif
   for (long long s = 0; s < (long long)n_extra_starts; ++s) {
     std::mt19937 rng(seed + s + 1);
-    auto pal = randomThenRefine(rng, cfg, k);
-    per_start[s] = minDeltaE(pal);
+    per_start[s] = refine(randomStartXYZ(rng, cfg, k), cfg, search);
+  }
+  for (auto& run : per_start) {
+    best.evaluations += run.evaluations;
+    double de = minDeltaE(run.palette);
+    if (de > best_de) {
+      best_de = de;
+      best.palette = std::move(run.palette);
+    }
   }
-  for (double v : per_start)
-    best = std::max(best, v);
   return best;
 }
 
@@ -183,43 +223,49 @@ main()
   const std::vector<size_t> ms = { 0, 4, 9, 24 };
   const uint64_t seed = 1234;
 
-  std::cout << "config,k,n_points,strategy,extra_starts,total_ms,min_de\n";
+  std::cout << "config,k,n_points,strategy,local_search,extra_starts,total_ms,"
+               "evaluations,min_de\n";
 
   for (const auto& cfg : CFGS) {
     for (size_t k : ks) {
       // Discrete-only baseline.
       {
         auto t0 = std::chrono::high_resolution_clock::now();
-        auto pal = standardPipeline(cfg, n_points, k, false);
-        auto t1 = std::chrono::high_resolution_clock::now();
-        double ms_ =
-          std::chrono::duration<double, std::milli>(t1 - t0).count();
-        std::cout << cfg.name << "," << k << "," << n_points
-                  << ",discrete_only,0," << ms_ << "," << minDeltaE(pal)
-                  << "\n";
-      }
-      // Single-start refined (current commit).
-      {
-        auto t0 = std::chrono::high_resolution_clock::now();
-        auto pal = standardPipeline(cfg, n_points, k, true);
+        auto pal = discretePipeline(cfg, n_points, k);
         auto t1 = std::chrono::high_resolution_clock::now();
         double ms_ =
           std::chrono::duration<double, std::milli>(t1 - t0).count();
         std::cout << cfg.name << "," << k << "," << n_points
-                  << ",single_start,0," << ms_ << "," << minDeltaE(pal)
-                  << "\n";
+                  << ",discrete_only,none,0," << ms_ << ",0,"
+                  << minDeltaE(pal) << "\n";
       }
-      // Multi-start: production seed + M random starts.
-      for (size_t M : ms) {
-        if (M == 0)
-          continue;
-        auto t0 = std::chrono::high_resolution_clock::now();
-        double best = runMultistart(cfg, n_points, k, M, seed);
-        auto t1 = std::chrono::high_resolution_clock::now();
-        double ms_ =
-          std::chrono::duration<double, std::milli>(t1 - t0).count();
-        std::cout << cfg.name << "," << k << "," << n_points << ",multistart,"
-                  << M << "," << ms_ << "," << best << "\n";
+      for (const auto& search : SEARCHES) {
+        // Single-start refined (the default).
+        {
+          auto t0 = std::chrono::high_resolution_clock::now();
+          auto run = singleStart(cfg, n_points, k, search.search);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          double ms_ =
+            std::chrono::duration<double, std::milli>(t1 - t0).count();
+          std::cout << cfg.name << "," << k << "," << n_points
+                    << ",single_start," << search.name << ",0," << ms_ << ","
+                    << run.evaluations << "," << minDeltaE(run.palette)
+                    << "\n";
+        }
+        // Multi-start: production seed + M random starts.
+        for (size_t M : ms) {
+          if (M == 0)
+            continue;
+          auto t0 = std::chrono::high_resolution_clock::now();
+          auto run = runMultistart(cfg, n_points, k, M, seed, search.search);
+          auto t1 = std::chrono::high_resolution_clock::now();
+          double ms_ =
+            std::chrono::duration<double, std::milli>(t1 - t0).count();
+          std::cout << cfg.name << "," << k << "," << n_points
+                    << ",multistart," << search.name << "," << M << ","
+                    << ms_ << "," << run.evaluations << ","
+                    << minDeltaE(run.palette) << "\n";
+        }
       }
     }
   }